@@ -0,0 +1,445 @@
+// Copyright (c) 2015 CNRS
+// Authors: Stanislas Brossette, Adrien Escande
+
+// This file is part of manifolds
+// manifolds is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+
+// manifolds is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// manifolds. If not, see
+// <http://www.gnu.org/licenses/>.
+
+// Microbenchmarks of the public operations of the manifolds.
+//
+// Usage: ManifoldsBench [--json file] [--filter substring] [--min-time s]
+//                       [--repetitions n]
+//
+// Each benchmark is run --repetitions times, each repetition looping on the
+// operation for at least --min-time seconds. The reported time per operation
+// is the median over the repetitions. The random points are drawn from a
+// fixed seed so that two runs time the same inputs.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <manifolds/defs.h>
+#include <manifolds/RealSpace.h>
+#include <manifolds/S2.h>
+#include <manifolds/SO3.h>
+#include <manifolds/ExpMapMatrix.h>
+#include <manifolds/ExpMapQuaternion.h>
+#include <manifolds/CayleyMapMatrix.h>
+#include <manifolds/CayleyMapQuaternion.h>
+#include <manifolds/FastTrig.h>
+#include <manifolds/CartesianProduct.h>
+#include <manifolds/CartesianPower.h>
+#include <manifolds/StaticCartesianProduct.h>
+
+using namespace mnf;
+
+namespace
+{
+struct Options
+{
+  std::string json;
+  std::string filter;
+  double minTime = 0.05;
+  int repetitions = 5;
+};
+
+struct Result
+{
+  std::string name;
+  std::string manifold;
+  std::string operation;
+  Index representationDim;
+  Index tangentDim;
+  long iterations;
+  int repetitions;
+  double median;  // ns per operation
+  double min;
+  double mean;
+};
+
+/// \brief Number of columns of the matrices given to the apply* operations,
+/// that is the number of rows of a typical constraint Jacobian
+const Index jacobianRows = 6;
+
+/// \brief Numbers of points of the batched operations
+const Index batchSizes[] = {1, 16, 256};
+
+/// \brief Prevents the compiler from discarding the results of the loops
+volatile double sink;
+
+typedef std::chrono::steady_clock Clock;
+
+template <typename Op>
+double seconds(Op& op, long n)
+{
+  Clock::time_point start = Clock::now();
+  for (long i = 0; i < n; ++i) op();
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/// \brief Times op, see the usage at the top of this file
+template <typename Op>
+void run(std::vector<Result>& results, const Options& opt,
+         const std::string& manifold, const Manifold& M,
+         const std::string& operation, Op op)
+{
+  std::string name = manifold + "/" + operation;
+  if (name.find(opt.filter) == std::string::npos) return;
+
+  // calibration: doubles the number of iterations until a loop lasts at least
+  // a tenth of min-time, then extrapolates
+  long n = 1;
+  double t = seconds(op, n);
+  while (t < opt.minTime / 10 && n < (1L << 40))
+  {
+    n *= 2;
+    t = seconds(op, n);
+  }
+  if (t < opt.minTime && t > 0)
+    n = std::max(n, static_cast<long>(n * opt.minTime / t));
+
+  std::vector<double> times;
+  for (int r = 0; r < opt.repetitions; ++r)
+    times.push_back(seconds(op, n) * 1e9 / static_cast<double>(n));
+  std::vector<double> sorted(times);
+  std::sort(sorted.begin(), sorted.end());
+
+  Result res;
+  res.name = name;
+  res.manifold = manifold;
+  res.operation = operation;
+  res.representationDim = M.representationDim();
+  res.tangentDim = M.tangentDim();
+  res.iterations = n;
+  res.repetitions = opt.repetitions;
+  res.median = sorted[sorted.size() / 2];
+  res.min = sorted.front();
+  res.mean = 0;
+  for (size_t i = 0; i < times.size(); ++i) res.mean += times[i];
+  res.mean /= static_cast<double>(times.size());
+  results.push_back(res);
+
+  std::cout.width(60);
+  std::cout << std::left << name << " " << res.median << " ns" << std::endl;
+}
+
+/// \brief Times all the public operations of M
+void benchManifold(std::vector<Result>& results, const Options& opt,
+                   const std::string& label, const Manifold& M)
+{
+  Index r = M.representationDim();
+  Index t = M.tangentDim();
+  Index c = jacobianRows;
+
+  std::srand(0);
+  Eigen::VectorXd x(r), y(r), z(r), xn(r), v(t), w(t);
+  M.createRandomPoint(x);
+  M.createRandomPoint(y);
+  // small increments, within the domain of the exponential maps
+  M.forceOnTxM(v, 0.1 * Eigen::VectorXd::Random(t), x);
+  xn = x + 1e-3 * Eigen::VectorXd::Random(r);
+  Eigen::MatrixXd Jr = Eigen::MatrixXd::Random(c, r);
+  Eigen::MatrixXd Jt = Eigen::MatrixXd::Random(c, t);
+  Eigen::MatrixXd Ht = Eigen::MatrixXd::Random(t, c);
+  Eigen::MatrixXd outR(c, r), outT(c, t), outH(t, c);
+  Eigen::MatrixXd Jx(t, r), Jy(t, r), Jv(r, t);
+
+  // sparse constraints: each row depends on 2 coefficients, at both ends of
+  // the variable
+  Eigen::MatrixXd sparseR = Eigen::MatrixXd::Zero(c, r);
+  Eigen::MatrixXd sparseT = Eigen::MatrixXd::Zero(c, t);
+  for (Index i = 0; i < c; ++i)
+  {
+    sparseR(i, i % r) = sparseR(i, r - 1 - i % r) = 1;
+    sparseT(i, i % t) = sparseT(i, t - 1 - i % t) = 1;
+  }
+  SparseRowMat inR = sparseR.sparseView(), inT = sparseT.sparseView();
+  SparseRowMat sparseOutR, sparseOutT;
+
+  run(results, opt, label, M, "retractation", [&]()
+      {
+        M.retractation(z, x, v);
+        sink = z[0];
+      });
+  run(results, opt, label, M, "pseudoLog", [&]()
+      {
+        M.pseudoLog(w, x, y);
+        sink = w[0];
+      });
+  run(results, opt, label, M, "pseudoLog0", [&]()
+      {
+        M.pseudoLog0(w, x);
+        sink = w[0];
+      });
+  run(results, opt, label, M, "retractationWithJacobian", [&]()
+      {
+        M.retractationWithJacobian(z, Jv, x, v);
+        sink = Jv(0, 0);
+      });
+  run(results, opt, label, M, "pseudoLogWithJacobian", [&]()
+      {
+        M.pseudoLogWithJacobian(w, Jx, Jy, x, y);
+        sink = Jy(0, 0);
+      });
+  run(results, opt, label, M, "applyDiffRetractation", [&]()
+      {
+        M.applyDiffRetractation(outT, Jr, x);
+        sink = outT(0, 0);
+      });
+  run(results, opt, label, M, "applyDiffPseudoLog0", [&]()
+      {
+        M.applyDiffPseudoLog0(outR, Jt, x);
+        sink = outR(0, 0);
+      });
+  run(results, opt, label, M, "applyDiffRetractationSparse", [&]()
+      {
+        M.applyDiffRetractation(sparseOutT, inR, x);
+        sink = static_cast<double>(sparseOutT.nonZeros());
+      });
+  run(results, opt, label, M, "applyDiffPseudoLog0Sparse", [&]()
+      {
+        M.applyDiffPseudoLog0(sparseOutR, inT, x);
+        sink = static_cast<double>(sparseOutR.nonZeros());
+      });
+  run(results, opt, label, M, "applyTransport", [&]()
+      {
+        M.applyTransport(outH, Ht, x, v);
+        sink = outH(0, 0);
+      });
+  run(results, opt, label, M, "applyInvTransport", [&]()
+      {
+        M.applyInvTransport(outH, Ht, x, v);
+        sink = outH(0, 0);
+      });
+  run(results, opt, label, M, "applyInvTransportOnTheRight", [&]()
+      {
+        M.applyInvTransportOnTheRight(outT, Jt, x, v);
+        sink = outT(0, 0);
+      });
+  run(results, opt, label, M, "forceOnM", [&]()
+      {
+        M.forceOnM(z, xn);
+        sink = z[0];
+      });
+  run(results, opt, label, M, "forceOnTxM", [&]()
+      {
+        M.forceOnTxM(w, v, x);
+        sink = w[0];
+      });
+
+  for (Index n : batchSizes)
+  {
+    Eigen::MatrixXd X(r, n), Y(r, n), Z(r, n), V(t, n), W(t, n);
+    for (Index j = 0; j < n; ++j)
+    {
+      M.createRandomPoint(X.col(j));
+      M.createRandomPoint(Y.col(j));
+      M.forceOnTxM(V.col(j), 0.1 * Eigen::VectorXd::Random(t), X.col(j));
+    }
+    std::string s = "/" + std::to_string(n);
+    run(results, opt, label, M, "retractationBatch" + s, [&]()
+        {
+          M.retractationBatch(Z, X, V);
+          sink = Z(0, 0);
+        });
+    run(results, opt, label, M, "pseudoLogBatch" + s, [&]()
+        {
+          M.pseudoLogBatch(W, X, Y);
+          sink = W(0, 0);
+        });
+    run(results, opt, label, M, "pseudoLog0Batch" + s, [&]()
+        {
+          M.pseudoLog0Batch(W, X);
+          sink = W(0, 0);
+        });
+  }
+}
+
+std::string escape(const std::string& s)
+{
+  std::string out;
+  for (size_t i = 0; i < s.size(); ++i)
+  {
+    if (s[i] == '"' || s[i] == '\\') out += '\\';
+    out += s[i];
+  }
+  return out;
+}
+
+void writeJson(std::ostream& os, const std::vector<Result>& results,
+               const Options& opt)
+{
+  std::time_t now = std::time(0);
+  char date[32];
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+  os << "{\n  \"context\": {\n";
+  os << "    \"date\": \"" << date << "\",\n";
+#if defined(__clang__)
+  os << "    \"compiler\": \"clang " << __clang_version__ << "\",\n";
+#elif defined(__GNUC__)
+  os << "    \"compiler\": \"gcc " << __VERSION__ << "\",\n";
+#elif defined(_MSC_VER)
+  os << "    \"compiler\": \"msvc " << _MSC_VER << "\",\n";
+#endif
+  os << "    \"eigen\": \"" << EIGEN_WORLD_VERSION << "." << EIGEN_MAJOR_VERSION
+     << "." << EIGEN_MINOR_VERSION << "\",\n";
+#ifdef NDEBUG
+  os << "    \"assertions\": false,\n";
+#else
+  os << "    \"assertions\": true,\n";
+#endif
+#ifdef _OPENMP
+  os << "    \"openmp\": true,\n";
+#else
+  os << "    \"openmp\": false,\n";
+#endif
+  os << "    \"min_time\": " << opt.minTime << ",\n";
+  os << "    \"repetitions\": " << opt.repetitions << "\n  },\n";
+  os << "  \"benchmarks\": [";
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    const Result& res = results[i];
+    os << (i ? ",\n" : "\n") << "    {\n";
+    os << "      \"name\": \"" << escape(res.name) << "\",\n";
+    os << "      \"manifold\": \"" << escape(res.manifold) << "\",\n";
+    os << "      \"operation\": \"" << res.operation << "\",\n";
+    os << "      \"representation_dim\": " << res.representationDim << ",\n";
+    os << "      \"tangent_dim\": " << res.tangentDim << ",\n";
+    os << "      \"iterations\": " << res.iterations << ",\n";
+    os << "      \"repetitions\": " << res.repetitions << ",\n";
+    os << "      \"real_time\": " << res.median << ",\n";
+    os << "      \"min_time\": " << res.min << ",\n";
+    os << "      \"mean_time\": " << res.mean << ",\n";
+    os << "      \"time_unit\": \"ns\"\n    }";
+  }
+  os << "\n  ]\n}\n";
+}
+
+bool parse(Options& opt, int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg(argv[i]);
+    if (i + 1 < argc && arg == "--json")
+      opt.json = argv[++i];
+    else if (i + 1 < argc && arg == "--filter")
+      opt.filter = argv[++i];
+    else if (i + 1 < argc && arg == "--min-time")
+      opt.minTime = std::atof(argv[++i]);
+    else if (i + 1 < argc && arg == "--repetitions")
+      opt.repetitions = std::max(1, std::atoi(argv[++i]));
+    else
+    {
+      std::cerr << "Usage: " << argv[0] << " [--json file] [--filter "
+                                            "substring] [--min-time s] "
+                                            "[--repetitions n]" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int main(int argc, char** argv)
+{
+  Options opt;
+  if (!parse(opt, argc, argv)) return 1;
+
+  std::vector<Result> results;
+  RealSpace R3(3);
+  S2 s2;
+  SO3<ExpMapQuaternion> so3Q;
+  SO3<ExpMapMatrix> so3M;
+
+  const int realSizes[] = {3, 10, 100, 1000};
+  for (int n : realSizes)
+  {
+    RealSpace Rn(n);
+    benchManifold(results, opt, "R" + std::to_string(n), Rn);
+  }
+  benchManifold(results, opt, "S2", s2);
+  benchManifold(results, opt, "SO3<ExpMapQuaternion>", so3Q);
+  benchManifold(results, opt, "SO3<ExpMapMatrix>", so3M);
+  benchManifold(results, opt, "SO3<CayleyMapQuaternion>",
+                SO3<CayleyMapQuaternion>());
+  benchManifold(results, opt, "SO3<CayleyMapMatrix>", SO3<CayleyMapMatrix>());
+  benchManifold(results, opt, "SO3<FastTrig<ExpMapQuaternion>>",
+                SO3<FastTrig<ExpMapQuaternion> >());
+  benchManifold(results, opt, "SO3<FastTrig<ExpMapMatrix>>",
+                SO3<FastTrig<ExpMapMatrix> >());
+
+  // the same product, with the static and the runtime dispatch
+  RealSpace R6(6);
+  benchManifold(results, opt, "Static(R3xSO3<ExpMapQuaternion>xR6)",
+                StaticCartesianProduct<FixedRealSpace<3>,
+                                       SO3<ExpMapQuaternion>,
+                                       FixedRealSpace<6> >());
+  CartesianProduct R3SO3R6(R3, so3Q);
+  R3SO3R6.multiply(R6);
+  benchManifold(results, opt, "Dynamic(R3xSO3<ExpMapQuaternion>xR6)",
+                R3SO3R6);
+
+  // CartesianPower of each elementary manifold
+  const int powerSizes[] = {10, 100, 1000};
+  for (int n : powerSizes)
+  {
+    std::string s = std::to_string(n);
+    benchManifold(results, opt, "Power(S2," + s + ")", CartesianPower(s2, n));
+    benchManifold(results, opt, "Power(SO3<ExpMapQuaternion>," + s + ")",
+                  CartesianPower(so3Q, n));
+    benchManifold(results, opt, "Power(SO3<ExpMapMatrix>," + s + ")",
+                  CartesianPower(so3M, n));
+  }
+
+  // wide products: n leaves R3 x S2 x SO3<ExpMapQuaternion> x
+  // SO3<ExpMapMatrix> x R3 x ...
+  const Manifold* leaves[] = {&R3, &s2, &so3Q, &so3M};
+  const int wideSizes[] = {4, 16, 64, 256};
+  for (int n : wideSizes)
+  {
+    CartesianProduct wide;
+    for (int i = 0; i < n; ++i) wide.multiply(*leaves[i % 4]);
+    benchManifold(results, opt, "Wide(" + std::to_string(n) + ")", wide);
+  }
+
+  // deep products: ((R3 x SO3<ExpMapQuaternion>) x SO3<ExpMapQuaternion>) x...
+  const int deepSizes[] = {4, 16, 64};
+  for (int n : deepSizes)
+  {
+    std::shared_ptr<CartesianProduct> deep(new CartesianProduct(R3, so3Q));
+    for (int i = 2; i < n; ++i)
+      deep.reset(new CartesianProduct(*deep, so3Q));
+    benchManifold(results, opt, "Deep(" + std::to_string(n) + ")", *deep);
+  }
+
+  if (!opt.json.empty())
+  {
+    std::ofstream file(opt.json.c_str());
+    if (!file)
+    {
+      std::cerr << "Cannot open " << opt.json << std::endl;
+      return 1;
+    }
+    writeJson(file, results, opt);
+  }
+  return 0;
+}
@@ -18,19 +18,174 @@
 #ifndef _MANIFOLDS_CARTESIAN_POWER_H_
 #define _MANIFOLDS_CARTESIAN_POWER_H_
 
+#include <memory>
+
 #include <manifolds/defs.h>
 #include <manifolds/CartesianProduct.h>
 
 namespace mnf
 {
 /// \brief Manifold representing the cartesian product of n times the same
-/// manifold
+/// manifold.\n
+/// A single copy of the manifold is shared by the n factors, and the start
+/// indices of the factors are computed as i times their dimensions. The
+/// operations are run as one loop on this manifold, or as a single batched
+/// call when one exists (retractation, pseudoLog, pseudoLog0).\n
+/// With setParallelGrain, the factors are split in ranges of about grain
+/// coefficients of representation, processed concurrently by the map
+/// operations as the chunks of a CartesianProduct.\n
+/// A CartesianPower is locked at construction: unlike a CartesianProduct, it
+/// cannot be extended with multiply, which throws a std::runtime_error. To
+/// append manifolds to a power, build a CartesianProduct containing it.
 class MANIFOLDS_API CartesianPower : public CartesianProduct
 {
  public:
   /// \brief Constructor of the \f$ M^n m2\f$
   CartesianPower(const Manifold& M, const int n);
+
+  virtual size_t numberOfSubManifolds() const;
+  virtual const Manifold& operator()(const size_t i) const;
+
+  virtual std::string description(const std::string& prefix = "",
+                                  bool firstCall = true) const;
+  virtual std::string toString(
+      const ConstRefVec& val, const std::string& prefix = "",
+      const Eigen::IOFormat& fmt = mnf::defaultFormat) const;
+
+  virtual bool isSameTopology(const Manifold& other) const;
+
+ protected:
+  virtual bool isInM_(const Eigen::VectorXd& val, double prec) const;
+  virtual void forceOnM_(RefVec out, const ConstRefVec& in) const;
+  virtual void getIdentityOnTxM_(RefMat out, const ConstRefVec& x) const;
+
+  virtual Index startR(const size_t i) const;
+  virtual Index startT(const size_t i) const;
+
+  virtual void createRandomPoint_(RefVec out, const double coeff) const;
+  virtual void retractation_(RefVec out, const ConstRefVec& x,
+                             const ConstRefVec& v) const;
+  virtual void retractationBatch_(RefMat out, const ConstRefMat& X,
+                                  const ConstRefMat& V) const;
+  virtual void pseudoLog_(RefVec out, const ConstRefVec& x,
+                          const ConstRefVec& y) const;
+  virtual void pseudoLogBatch_(RefMat out, const ConstRefMat& X,
+                               const ConstRefMat& Y) const;
+  virtual void pseudoLog0_(RefVec out, const ConstRefVec& x) const;
+  virtual void pseudoLog0Batch_(RefMat out, const ConstRefMat& X) const;
+  virtual void setZero_(RefVec out) const;
+  virtual Eigen::MatrixXd diffRetractation_(const ConstRefVec& x) const;
+  virtual void retractationWithJacobian_(RefVec out, RefMat J,
+                                         const ConstRefVec& x,
+                                         const ConstRefVec& v) const;
+  virtual void pseudoLogWithJacobian_(RefVec out, RefMat Jx, RefMat Jy,
+                                      const ConstRefVec& x,
+                                      const ConstRefVec& y) const;
+  virtual void applyDiffRetractation_(RefMat out, const ConstRefMat& in,
+                                      const ConstRefVec& x) const;
+  virtual Eigen::MatrixXd diffPseudoLog0_(const ConstRefVec& x) const;
+  virtual void applyDiffPseudoLog0_(RefMat out, const ConstRefMat& in,
+                                    const ConstRefVec& x) const;
+  virtual void diffRetractationTriplets_(std::vector<Triplet>& out,
+                                         const ConstRefVec& x, Index startR,
+                                         Index startT,
+                                         const UsedRows* used) const;
+  virtual void diffPseudoLog0Triplets_(std::vector<Triplet>& out,
+                                       const ConstRefVec& x, Index startT,
+                                       Index startR,
+                                       const UsedRows* used) const;
+  virtual void applyTransport_(RefMat out, const ConstRefMat& in,
+                               const ConstRefVec& x,
+                               const ConstRefVec& v) const;
+  virtual void applyInvTransport_(RefMat out, const ConstRefMat& in,
+                                  const ConstRefVec& x,
+                                  const ConstRefVec& v) const;
+  virtual void applyInvTransportOnTheRight_(RefMat out, const ConstRefMat& in,
+                                            const ConstRefVec& x,
+                                            const ConstRefVec& v) const;
+
+  virtual void tangentConstraint_(RefMat out, const ConstRefVec& x) const;
+  virtual bool isInTxM_(const ConstRefVec& x, const ConstRefVec& v,
+                        const double& prec) const;
+  virtual void forceOnTxM_(RefVec out, const ConstRefVec& in,
+                           const ConstRefVec& x) const;
+  virtual void limitMap_(RefVec out) const;
+  virtual void getTypicalMagnitude_(RefVec out) const;
+  virtual void getTrustMagnitude_(RefVec out) const;
+
+  virtual std::shared_ptr<Manifold> getNewCopy_() const;
+
+  /// \brief Always throws: the number of factors is fixed at construction
+  virtual void testMultiply() const;
+
+  /// \brief The power loops on its factor itself, it is seen as a single
+  /// leaf by an enclosing product
+  virtual bool isFlattenable() const;
+
+ private:
+  /// \brief Calls op(i0, n) on consecutive ranges [i0, i0 + n) of factors
+  /// covering [0, n_): a single range, or ranges split according to
+  /// parallelGrain() that are processed in parallel
+  template <typename Op>
+  void forEachRange(const Op& op) const;
+
+  /// \brief Representation space of the n factors seen as the columns of a
+  /// matrix
+  Eigen::Map<Eigen::MatrixXd> columnsR(RefVec v) const;
+  Eigen::Map<const Eigen::MatrixXd> columnsR(const ConstRefVec& v) const;
+
+  /// \brief Tangent space of the n factors seen as the columns of a matrix
+  Eigen::Map<Eigen::MatrixXd> columnsT(RefVec v) const;
+  Eigen::Map<const Eigen::MatrixXd> columnsT(const ConstRefVec& v) const;
+
+  /// \brief The manifold shared by all the factors
+  std::shared_ptr<const Manifold> base_;
+
+  /// \brief Number of factors
+  size_t n_;
+
+  /// \brief Representation dimension of the factor
+  Index r_;
+
+  /// \brief Tangent dimension of the factor
+  Index t_;
 };
+
+inline Index CartesianPower::startR(const size_t i) const
+{
+  mnf_assert(i < numberOfSubManifolds() && "invalid index");
+  return static_cast<Index>(i) * r_;
+}
+
+inline Index CartesianPower::startT(const size_t i) const
+{
+  mnf_assert(i < numberOfSubManifolds() && "invalid index");
+  return static_cast<Index>(i) * t_;
+}
+
+inline Eigen::Map<Eigen::MatrixXd> CartesianPower::columnsR(RefVec v) const
+{
+  return Eigen::Map<Eigen::MatrixXd>(v.data(), r_, static_cast<Index>(n_));
+}
+
+inline Eigen::Map<const Eigen::MatrixXd> CartesianPower::columnsR(
+    const ConstRefVec& v) const
+{
+  return Eigen::Map<const Eigen::MatrixXd>(v.data(), r_,
+                                           static_cast<Index>(n_));
+}
+
+inline Eigen::Map<Eigen::MatrixXd> CartesianPower::columnsT(RefVec v) const
+{
+  return Eigen::Map<Eigen::MatrixXd>(v.data(), t_, static_cast<Index>(n_));
+}
+
+inline Eigen::Map<const Eigen::MatrixXd> CartesianPower::columnsT(
+    const ConstRefVec& v) const
+{
+  return Eigen::Map<const Eigen::MatrixXd>(v.data(), t_,
+                                           static_cast<Index>(n_));
+}
 }
 
 #endif  //_MANIFOLDS_CARTESIAN_POWER_H_
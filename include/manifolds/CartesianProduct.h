@@ -18,6 +18,7 @@
 #ifndef _MANIFOLDS_CARTESIAN_PRODUCT_H_
 #define _MANIFOLDS_CARTESIAN_PRODUCT_H_
 
+#include <functional>
 #include <vector>
 #include <stdexcept>
 #include <initializer_list>
@@ -43,9 +44,23 @@ class MANIFOLDS_API CartesianProduct : public Manifold
   CartesianProduct(const Manifold& m1, const Manifold& m2);
 
   /// \brief Adds manifold m to the current composed manifold\n
-  /// This method cannot be executed if the manifold is locked
+  /// This method cannot be executed if the manifold is locked, or if its
+  /// structure is fixed (see testMultiply)
   CartesianProduct& multiply(const Manifold& m);
 
+  /// \brief Enables the parallel execution of the map operations, when the
+  /// library is compiled with OpenMP.\n
+  /// The leaves are split in chunks of about grain coefficients of the
+  /// representation space, that are processed concurrently. Products with a
+  /// representation smaller than two chunks keep the serial execution. A
+  /// grain of 0, the default, disables the parallel execution.\n
+  /// A product multiplied into another one is flattened in the leaves of the
+  /// latter, so that its own grain is ignored: only the grain of the
+  /// outermost product applies. Products that are not flattened, like
+  /// CartesianPower, keep their own grain.
+  void setParallelGrain(Index grain);
+  Index parallelGrain() const;
+
   virtual size_t numberOfSubManifolds() const;
   virtual const Manifold& operator()(const size_t i) const;
 
@@ -69,16 +84,35 @@ class MANIFOLDS_API CartesianProduct : public Manifold
   virtual void createRandomPoint_(RefVec out, const double coeff) const;
   virtual void retractation_(RefVec out, const ConstRefVec& x,
                              const ConstRefVec& v) const;
+  virtual void retractationBatch_(RefMat out, const ConstRefMat& X,
+                                  const ConstRefMat& V) const;
   virtual void pseudoLog_(RefVec out, const ConstRefVec& x,
                           const ConstRefVec& y) const;
+  virtual void pseudoLogBatch_(RefMat out, const ConstRefMat& X,
+                               const ConstRefMat& Y) const;
   virtual void pseudoLog0_(RefVec out, const ConstRefVec& x) const;
+  virtual void pseudoLog0Batch_(RefMat out, const ConstRefMat& X) const;
   virtual void setZero_(RefVec out) const;
   virtual Eigen::MatrixXd diffRetractation_(const ConstRefVec& x) const;
+  virtual void retractationWithJacobian_(RefVec out, RefMat J,
+                                         const ConstRefVec& x,
+                                         const ConstRefVec& v) const;
+  virtual void pseudoLogWithJacobian_(RefVec out, RefMat Jx, RefMat Jy,
+                                      const ConstRefVec& x,
+                                      const ConstRefVec& y) const;
   virtual void applyDiffRetractation_(RefMat out, const ConstRefMat& in,
                                       const ConstRefVec& x) const;
   virtual Eigen::MatrixXd diffPseudoLog0_(const ConstRefVec& x) const;
   virtual void applyDiffPseudoLog0_(RefMat out, const ConstRefMat& in,
                                     const ConstRefVec& x) const;
+  virtual void diffRetractationTriplets_(std::vector<Triplet>& out,
+                                         const ConstRefVec& x, Index startR,
+                                         Index startT,
+                                         const UsedRows* used) const;
+  virtual void diffPseudoLog0Triplets_(std::vector<Triplet>& out,
+                                       const ConstRefVec& x, Index startT,
+                                       Index startR,
+                                       const UsedRows* used) const;
   virtual void applyTransport_(RefMat out, const ConstRefMat& in,
                                const ConstRefVec& x,
                                const ConstRefVec& v) const;
@@ -101,11 +135,77 @@ class MANIFOLDS_API CartesianProduct : public Manifold
 
   virtual std::shared_ptr<Manifold> getNewCopy_() const;
 
+  /// \brief Returns true if a product containing this one can dispatch the
+  /// map operations directly to the leaves of this product. Subclasses that
+  /// override the map operations must return false.
+  virtual bool isFlattenable() const;
+
  protected:
+  /// \brief Calls op(i) for i in [0, n), concurrently when the library is
+  /// compiled with OpenMP. An exception thrown by op is rethrown once all the
+  /// calls are done.
+  static void parallelFor(int n, const std::function<void(int)>& op);
+
+  /// \brief Throws if multiply cannot be executed. By default, it is
+  /// testLock: a locked product cannot be modified. Products with a fixed
+  /// structure override it to give their own message.
+  virtual void testMultiply() const;
+
   /// \brief List of pointers on all the manifolds in the cartesian product
   std::vector<std::shared_ptr<const Manifold>> subManifolds_;
 
  private:
+  /// \brief A run of count consecutive manifolds that are not flattened
+  /// further in the tree of nested products, with the position of the run
+  /// in the vectors of this product and the dimensions of one manifold.\n
+  /// All the manifolds of a run have the same type and dimensions, the
+  /// operations are done through the first one.
+  struct Leaf
+  {
+    const Manifold* manifold;
+    Index startR;
+    Index startT;
+    Index dimR;
+    Index dimT;
+    Index count;
+  };
+
+  /// \brief Appends the leaves of m, whose block starts at startR and
+  /// startT, to leaves_
+  void appendLeaves(const Manifold& m, Index startR, Index startT);
+
+  /// \brief Appends l to leaves_, merging it with the last run if they have
+  /// the same type and dimensions. Adjacent real spaces are merged in a
+  /// single real space, whatever their dimensions.
+  void pushLeaf(const Leaf& l);
+
+  /// \brief Flat list of the runs of leaves of the tree of nested products.
+  /// The map operations loop over it instead of recursing in the
+  /// subproducts.\n
+  /// The leaves are owned by subManifolds_, which are locked copies, or by
+  /// mergedLeaves_, so that the pointers stay valid for the lifetime of this
+  /// product and its copies.
+  std::vector<Leaf> leaves_;
+
+  /// \brief Real spaces created by merging adjacent real spaces
+  std::vector<std::shared_ptr<const Manifold>> mergedLeaves_;
+
+  /// \brief Computes chunks_ from leaves_ and parallelGrain_
+  void buildChunks();
+
+  /// \brief Applies op on every run of leaves_, or on every element of
+  /// chunks_ in parallel when it is not empty
+  template <typename Op>
+  void forEachLeaf(const Op& op) const;
+
+  /// \brief Minimal size of a chunk for the parallel execution
+  Index parallelGrain_;
+
+  /// \brief The runs of leaves_, split so that each chunk has about
+  /// parallelGrain_ coefficients of representation. Empty if the operations
+  /// are executed serially, which is always the case without OpenMP.
+  std::vector<Leaf> chunks_;
+
   /// \brief List of start index of submanifolds in a vector of the
   /// tangent space
   std::vector<Index> startIndexT_;
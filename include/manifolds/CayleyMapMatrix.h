@@ -0,0 +1,75 @@
+// Copyright (c) 2015 CNRS
+// Authors: Stanislas Brossette, Adrien Escande
+
+// This file is part of manifolds
+// manifolds is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+
+// manifolds is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// manifolds. If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef _MANIFOLDS_CAYLEYMAPMATRIX_H_
+#define _MANIFOLDS_CAYLEYMAPMATRIX_H_
+
+#include <Eigen/Core>
+#include <manifolds/defs.h>
+#include <manifolds/ExpMapMatrix.h>
+#include <manifolds/ReusableTemporaryMap.h>
+
+namespace mnf
+{
+/// \brief Structure representing the Cayley map going from
+/// \f$ \mathbb{R}^3 \f$ to SO(3) represented in the 3x3 matrix space
+/// as a vector.\n
+/// The Cayley map of v is \f$ (I - [v]_\times/2)^{-1} (I + [v]_\times/2) \f$,
+/// the rotation of angle \f$ 2\arctan(|v|/2) \f$ around v, see
+/// CayleyMapQuaternion.
+struct MANIFOLDS_API CayleyMapMatrix : public ExpMapMatrix
+{
+  static void retractation_(RefVec out, const ConstRefVec& x,
+                            const ConstRefVec& v);
+  static void pseudoLog_(RefVec out, const ConstRefVec& x,
+                         const ConstRefVec& y);
+  static void pseudoLog0_(RefVec out, const ConstRefVec& x);
+  /// \brief Versions of retractation_, pseudoLog_ and pseudoLog0_ working on
+  /// each column of the matrices
+  static void retractationBatch_(RefMat out, const ConstRefMat& X,
+                                 const ConstRefMat& V);
+  static void pseudoLogBatch_(RefMat out, const ConstRefMat& X,
+                              const ConstRefMat& Y);
+  static void pseudoLog0Batch_(RefMat out, const ConstRefMat& X);
+
+  /// \brief R = cay(v)
+  static void cayley(OutputType& out, const ConstRefVec& v);
+  /// \brief v = cay^{-1}(R)
+  static void invCayley(RefVec out, const OutputType& R);
+
+  /// \brief retractation_ together with its derivative with respect to v
+  static void retractationWithJacobian_(RefVec out, RefMat J,
+                                        const ConstRefVec& x,
+                                        const ConstRefVec& v);
+  /// \brief pseudoLog_ together with its derivatives with respect to x and y
+  static void pseudoLogWithJacobian_(RefVec out, RefMat Jx, RefMat Jy,
+                                     const ConstRefVec& x,
+                                     const ConstRefVec& y);
+  static Eigen::Matrix<double, 3, 9> diffPseudoLog0_(const ConstRefVec& x);
+  static void applyDiffPseudoLog0_(RefMat out, const ConstRefMat& in,
+                                   const ConstRefVec& x,
+                                   ReusableTemporaryMap& m);
+
+#if defined(_MSC_FULL_VER) && _MSC_VER < 1900
+  static char hashName[];
+#else
+  constexpr static char hashName[] = "CayleyMapMatrix";
+#endif
+};
+}
+
+#endif  //_MANIFOLDS_CAYLEYMAPMATRIX_H_
@@ -0,0 +1,80 @@
+// Copyright (c) 2015 CNRS
+// Authors: Stanislas Brossette, Adrien Escande
+
+// This file is part of manifolds
+// manifolds is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+
+// manifolds is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// manifolds. If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef _MANIFOLDS_CAYLEYMAPQUATERNION_H_
+#define _MANIFOLDS_CAYLEYMAPQUATERNION_H_
+
+#include <Eigen/Core>
+#include <manifolds/defs.h>
+#include <manifolds/ExpMapQuaternion.h>
+#include <manifolds/ReusableTemporaryMap.h>
+
+namespace mnf
+{
+/// \brief Structure representing the Cayley map going from
+/// \f$ \mathbb{R}^3 \f$ to SO(3) represented in the quaternion space
+/// as a vector, the quaternions are represented as q = (w, x, y, z).\n
+/// The Cayley map of v is the rotation of angle \f$ 2\arctan(|v|/2) \f$
+/// around v, that is the normalization of the quaternion (1, v/2). It is a
+/// retractation of order 2 that does not need any trigonometric function,
+/// and that is defined for any v. Its inverse is defined for the rotations
+/// of angle strictly smaller than pi.\n
+/// The rest of the structure (constraints on the tangent space, transports)
+/// is shared with ExpMapQuaternion. The derivative of the retractation in
+/// v = 0 is the same as the one of the exponential map.
+struct MANIFOLDS_API CayleyMapQuaternion : public ExpMapQuaternion
+{
+  static void retractation_(RefVec out, const ConstRefVec& x,
+                            const ConstRefVec& v);
+  static void pseudoLog_(RefVec out, const ConstRefVec& x,
+                         const ConstRefVec& y);
+  static void pseudoLog0_(RefVec out, const ConstRefVec& x);
+  /// \brief Versions of retractation_, pseudoLog_ and pseudoLog0_ working on
+  /// each column of the matrices
+  static void retractationBatch_(RefMat out, const ConstRefMat& X,
+                                 const ConstRefMat& V);
+  static void pseudoLogBatch_(RefMat out, const ConstRefMat& X,
+                              const ConstRefMat& Y);
+  static void pseudoLog0Batch_(RefMat out, const ConstRefMat& X);
+
+  /// \brief q = cay(v)
+  static void cayley(OutputType& out, const ConstRefVec& v);
+  /// \brief v = cay^{-1}(q)
+  static void invCayley(RefVec out, const ConstRefVec& q);
+
+  /// \brief retractation_ together with its derivative with respect to v
+  static void retractationWithJacobian_(RefVec out, RefMat J,
+                                        const ConstRefVec& x,
+                                        const ConstRefVec& v);
+  /// \brief pseudoLog_ together with its derivatives with respect to x and y
+  static void pseudoLogWithJacobian_(RefVec out, RefMat Jx, RefMat Jy,
+                                     const ConstRefVec& x,
+                                     const ConstRefVec& y);
+  static Eigen::Matrix<double, 3, 4> diffPseudoLog0_(const ConstRefVec& x);
+  static void applyDiffPseudoLog0_(RefMat out, const ConstRefMat& in,
+                                   const ConstRefVec& x,
+                                   ReusableTemporaryMap& m);
+
+#if defined(_MSC_FULL_VER) && _MSC_VER < 1900
+  static char hashName[];
+#else
+  constexpr static char hashName[] = "CayleyMapQuaternion";
+#endif
+};
+}
+
+#endif  //_MANIFOLDS_CAYLEYMAPQUATERNION_H_
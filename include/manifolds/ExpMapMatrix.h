@@ -47,11 +47,42 @@ struct MANIFOLDS_API ExpMapMatrix
                          const ConstRefVec& y);
   static void pseudoLog0_(RefVec out, const ConstRefVec& x);
   static void setZero_(RefVec out);
+  /// \brief Versions of retractation_, pseudoLog_ and pseudoLog0_ working on
+  /// each column of the matrices
+  static void retractationBatch_(RefMat out, const ConstRefMat& X,
+                                 const ConstRefMat& V);
+  static void pseudoLogBatch_(RefMat out, const ConstRefMat& X,
+                              const ConstRefMat& Y);
+  static void pseudoLog0Batch_(RefMat out, const ConstRefMat& X);
 
   static void logarithm(RefVec out, const OutputType& M);
+  /// \brief Computes the logarithm of R and its derivative with respect to
+  /// R, diffPseudoLog0_(R), sharing the trigonometric terms
+  static void logarithmWithJacobian(RefVec out, Eigen::Matrix<double, 3, 9>& J,
+                                    const ConstRefVec& R);
   static void exponential(OutputType& out, const ConstRefVec& v);
+  /// \brief Computes the exponential of each column of V (3xN) in the
+  /// columns of out (9xN), see ExpMapQuaternion::exponentialBatch
+  static void exponentialBatch(RefMat out, const ConstRefMat& V);
+  /// \brief Computes the logarithm of each column of R (9xN) in the columns
+  /// of out (3xN), see ExpMapQuaternion::exponentialBatch
+  static void logarithmBatch(RefMat out, const ConstRefMat& R);
 
   static Eigen::Matrix<double, 9, 3> diffRetractation_(const ConstRefVec& x);
+  /// \brief retractation_ together with its derivative with respect to v
+  static void retractationWithJacobian_(RefVec out, RefMat J,
+                                        const ConstRefVec& x,
+                                        const ConstRefVec& v);
+  /// \brief pseudoLog_ together with its derivatives with respect to x and y
+  static void pseudoLogWithJacobian_(RefVec out, RefMat Jx, RefMat Jy,
+                                     const ConstRefVec& x,
+                                     const ConstRefVec& y);
+  /// \brief Jx = D*dR/dx and Jy = D*dR/dy for R = x^T*y, where D is a
+  /// derivative with respect to R
+  static void applyDiffTransposeProduct(RefMat Jx, RefMat Jy,
+                                        const Eigen::Matrix<double, 3, 9>& D,
+                                        const ConstRefVec& x,
+                                        const ConstRefVec& y);
   static void applyDiffRetractation_(RefMat out, const ConstRefMat& in,
                                      const ConstRefVec& x,
                                      ReusableTemporaryMap& m);
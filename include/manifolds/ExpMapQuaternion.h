@@ -45,6 +45,91 @@ class MANIFOLDS_API ConstReverseQuaternion : public Eigen::Quaterniond
   ConstReverseQuaternion(const double* data);
   ~ConstReverseQuaternion() {}
 };
+
+/// \brief Read-only view on a quaternion stored as (w, x, y, z).\n
+/// Eigen::Map<Eigen::Quaterniond> expects the (x, y, z, w) layout, and
+/// ReverseQuaternion copies the coefficients. This view works directly on the
+/// data: w is data[0] and the vector part is the contiguous data[1..3].
+class ConstQuaternionWxyzMap
+{
+ public:
+  explicit ConstQuaternionWxyzMap(const double* data) : data_(data) {}
+
+  double w() const { return data_[0]; }
+  double x() const { return data_[1]; }
+  double y() const { return data_[2]; }
+  double z() const { return data_[3]; }
+  Eigen::Map<const Eigen::Vector3d> vec() const
+  {
+    return Eigen::Map<const Eigen::Vector3d>(data_ + 1);
+  }
+  /// \brief The four coefficients, in the (w, x, y, z) order
+  Eigen::Map<const Eigen::Vector4d> wxyz() const
+  {
+    return Eigen::Map<const Eigen::Vector4d>(data_);
+  }
+
+  double squaredNorm() const { return wxyz().squaredNorm(); }
+  double norm() const { return wxyz().norm(); }
+
+ protected:
+  const double* data_;
+};
+
+/// \brief Writable view on a quaternion stored as (w, x, y, z), see
+/// ConstQuaternionWxyzMap.\n
+/// The products can be written in one of their operands.
+class QuaternionWxyzMap : public ConstQuaternionWxyzMap
+{
+ public:
+  explicit QuaternionWxyzMap(double* data) : ConstQuaternionWxyzMap(data) {}
+
+  double& w() { return data()[0]; }
+  Eigen::Map<Eigen::Vector3d> vec()
+  {
+    return Eigen::Map<Eigen::Vector3d>(data() + 1);
+  }
+  Eigen::Map<Eigen::Vector4d> wxyz()
+  {
+    return Eigen::Map<Eigen::Vector4d>(data());
+  }
+  using ConstQuaternionWxyzMap::w;
+  using ConstQuaternionWxyzMap::vec;
+  using ConstQuaternionWxyzMap::wxyz;
+
+  void setIdentity()
+  {
+    w() = 1;
+    vec().setZero();
+  }
+  void normalize() { wxyz().normalize(); }
+
+  /// \brief this = a * b
+  void setProduct(const ConstQuaternionWxyzMap& a,
+                  const ConstQuaternionWxyzMap& b)
+  {
+    double rw = a.w() * b.w() - a.vec().dot(b.vec());
+    Eigen::Vector3d rv =
+        a.w() * b.vec() + b.w() * a.vec() + a.vec().cross(b.vec());
+    w() = rw;
+    vec() = rv;
+  }
+
+  /// \brief this = a^{-1} * b
+  void setInverseProduct(const ConstQuaternionWxyzMap& a,
+                         const ConstQuaternionWxyzMap& b)
+  {
+    double n2 = a.squaredNorm();
+    double rw = (a.w() * b.w() + a.vec().dot(b.vec())) / n2;
+    Eigen::Vector3d rv =
+        (a.w() * b.vec() - b.w() * a.vec() - a.vec().cross(b.vec())) / n2;
+    w() = rw;
+    vec() = rv;
+  }
+
+ private:
+  double* data() { return const_cast<double*>(data_); }
+};
 }
 
 /// \brief Structure representing the exponential map going from
@@ -71,11 +156,44 @@ struct MANIFOLDS_API ExpMapQuaternion
                          const ConstRefVec& y);
   static void pseudoLog0_(RefVec out, const ConstRefVec& x);
   static void setZero_(RefVec out);
+  /// \brief Versions of retractation_, pseudoLog_ and pseudoLog0_ working on
+  /// each column of the matrices
+  static void retractationBatch_(RefMat out, const ConstRefMat& X,
+                                 const ConstRefMat& V);
+  static void pseudoLogBatch_(RefMat out, const ConstRefMat& X,
+                              const ConstRefMat& Y);
+  static void pseudoLog0Batch_(RefMat out, const ConstRefMat& X);
 
   static void logarithm(RefVec out, const OutputType& M);
+  /// \brief Computes the logarithm of q and its derivative with respect to
+  /// q, diffPseudoLog0_(q), sharing the trigonometric terms
+  static void logarithmWithJacobian(RefVec out, Eigen::Matrix<double, 3, 4>& J,
+                                    const ConstRefVec& q);
   static void exponential(OutputType& out, const ConstRefVec& v);
+  /// \brief Computes the exponential of each column of V (3xN) in the
+  /// columns of out (4xN).\n
+  /// The columns are processed by blocks, in a structure-of-arrays layout
+  /// that Eigen vectorizes.
+  static void exponentialBatch(RefMat out, const ConstRefMat& V);
+  /// \brief Computes the logarithm of each column of Q (4xN) in the columns
+  /// of out (3xN), see exponentialBatch
+  static void logarithmBatch(RefMat out, const ConstRefMat& Q);
 
   static Eigen::Matrix<double, 4, 3> diffRetractation_(const ConstRefVec& x);
+  /// \brief retractation_ together with its derivative with respect to v
+  static void retractationWithJacobian_(RefVec out, RefMat J,
+                                        const ConstRefVec& x,
+                                        const ConstRefVec& v);
+  /// \brief pseudoLog_ together with its derivatives with respect to x and y
+  static void pseudoLogWithJacobian_(RefVec out, RefMat Jx, RefMat Jy,
+                                     const ConstRefVec& x,
+                                     const ConstRefVec& y);
+  /// \brief Jx = D*dq/dx and Jy = D*dq/dy for q = x^{-1}*y, where D is a
+  /// derivative with respect to q
+  static void applyDiffInverseProduct(RefMat Jx, RefMat Jy,
+                                      const Eigen::Matrix<double, 3, 4>& D,
+                                      const ConstRefVec& x,
+                                      const ConstRefVec& y);
   static void applyDiffRetractation_(RefMat out, const ConstRefMat& in,
                                      const ConstRefVec& x,
                                      ReusableTemporaryMap& m);
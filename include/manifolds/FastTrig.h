@@ -0,0 +1,89 @@
+// Copyright (c) 2015 CNRS
+// Authors: Stanislas Brossette, Adrien Escande
+
+// This file is part of manifolds
+// manifolds is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+
+// manifolds is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// manifolds. If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef _MANIFOLDS_FAST_TRIG_H_
+#define _MANIFOLDS_FAST_TRIG_H_
+
+#include <Eigen/Core>
+#include <manifolds/defs.h>
+#include <manifolds/ExpMapMatrix.h>
+#include <manifolds/ExpMapQuaternion.h>
+
+namespace mnf
+{
+/// \brief Precision policy for the maps of SO3: SO3<FastTrig<Map>> replaces
+/// the calls to std::sin, std::cos, std::acos and std::atan2 of the
+/// exponential, logarithm, retractation and pseudoLog of Map by polynomial
+/// and rational approximations.\n
+/// The exponential uses truncated series of the half angle
+/// \f$ h = |v|/2 \le \pi/2 \f$: the error on the coefficients of the result
+/// is below errorBound = 1e-9, and decreases as \f$ |v|^{16} \f$ (it is at
+/// the machine precision for \f$ |v| < 0.5 \f$). The logarithm uses the
+/// rational approximation of atan of the Cephes library and is accurate to
+/// the machine precision.\n
+/// The derivatives and the batched operations are those of Map, the latter
+/// are already computed without trigonometric calls. retractationWithJacobian_
+/// is also the one of Map, with the exact trigonometric functions.
+template <typename Map>
+struct FastTrig;
+
+template <>
+struct MANIFOLDS_API FastTrig<ExpMapMatrix> : public ExpMapMatrix
+{
+  /// \brief bound on the error of the coefficients of the results
+  static const double errorBound;
+
+  static void retractation_(RefVec out, const ConstRefVec& x,
+                            const ConstRefVec& v);
+  static void pseudoLog_(RefVec out, const ConstRefVec& x,
+                         const ConstRefVec& y);
+  static void pseudoLog0_(RefVec out, const ConstRefVec& x);
+
+  static void logarithm(RefVec out, const OutputType& M);
+  static void exponential(OutputType& out, const ConstRefVec& v);
+
+#if defined(_MSC_FULL_VER) && _MSC_VER < 1900
+  static char hashName[];
+#else
+  constexpr static char hashName[] = "FastTrigExpMapMatrix";
+#endif
+};
+
+template <>
+struct MANIFOLDS_API FastTrig<ExpMapQuaternion> : public ExpMapQuaternion
+{
+  /// \brief bound on the error of the coefficients of the results
+  static const double errorBound;
+
+  static void retractation_(RefVec out, const ConstRefVec& x,
+                            const ConstRefVec& v);
+  static void pseudoLog_(RefVec out, const ConstRefVec& x,
+                         const ConstRefVec& y);
+  static void pseudoLog0_(RefVec out, const ConstRefVec& x);
+
+  static void logarithm(RefVec out, const OutputType& M);
+  static void exponential(OutputType& out, const ConstRefVec& v);
+
+#if defined(_MSC_FULL_VER) && _MSC_VER < 1900
+  static char hashName[];
+#else
+  constexpr static char hashName[] = "FastTrigExpMapQuaternion";
+#endif
+};
+}
+
+#endif  //_MANIFOLDS_FAST_TRIG_H_
@@ -77,6 +77,14 @@ class MANIFOLDS_API Manifold : public RefCounter, public ValidManifold
   Point createRandomPoint(double coeff = 1.0) const;
   void createRandomPoint(RefVec out, double coeff = 1.0) const;
 
+  /// \brief Sets the arena from which the memory of the points created by
+  /// this manifold is taken. With the default, 0x0, points are allocated on
+  /// the heap.\n
+  /// The arena is not owned by the manifold. It must outlive the points
+  /// allocated in it, and be changed only when no such point exists.
+  void setPointArena(PointArena* arena);
+  PointArena* pointArena() const;
+
   /// \brief Checks that the value val described in the representation space
   /// is an element of the manifold
   virtual bool isInM(const Eigen::VectorXd& val, double prec = 1e-8) const;
@@ -162,6 +170,15 @@ class MANIFOLDS_API Manifold : public RefCounter, public ValidManifold
   void retractation(RefVec out, const ConstRefVec& x,
                     const ConstRefVec& v) const;
 
+  /// \brief Batched external addition \f$ out_j = X_j \oplus V_j \f$
+  /// applied to N points at once
+  /// \param out output matrix, each column is an element of the manifold
+  /// \param X matrix whose columns are elements of the manifold
+  /// \param V matrix whose column j is an element of \f$ T_{X_j}^\mathcal{M}
+  /// \f$
+  void retractationBatch(RefMat out, const ConstRefMat& X,
+                         const ConstRefMat& V) const;
+
   /// \brief PseudoLog operation
   /// \f$ out = {Log}_x(y) \f$
   /// \param out output reference on element of the tangent space of the
@@ -170,6 +187,14 @@ class MANIFOLDS_API Manifold : public RefCounter, public ValidManifold
   /// \param y element of the manifold \f$y\in\mathbb{M}\f$
   void pseudoLog(RefVec out, const ConstRefVec& x, const ConstRefVec& y) const;
 
+  /// \brief Batched pseudoLog operation \f$ out_j = {Log}_{X_j}(Y_j) \f$
+  /// applied to N pairs of points at once
+  /// \param out output matrix, each column is an element of the tangent space
+  /// \param X matrix whose columns are elements of the manifold
+  /// \param Y matrix whose columns are elements of the manifold
+  void pseudoLogBatch(RefMat out, const ConstRefMat& X,
+                      const ConstRefMat& Y) const;
+
   /// \brief computes the inverse of a point of the manifold through its map
   /// \f$ out = x \ominus 0 = \phi_0^{-1}(x) \f$
   /// \param out output reference on element of the tangent space of the
@@ -177,12 +202,25 @@ class MANIFOLDS_API Manifold : public RefCounter, public ValidManifold
   /// \param x element of the manifold\f$x\in\mathbb{M}\f$
   void pseudoLog0(RefVec out, const ConstRefVec& x) const;
 
+  /// \brief Batched pseudoLog0 operation \f$ out_j = \phi_0^{-1}(X_j) \f$
+  /// applied to N points at once
+  /// \param out output matrix, each column is an element of the tangent space
+  /// \param X matrix whose columns are elements of the manifold
+  void pseudoLog0Batch(RefMat out, const ConstRefMat& X) const;
+
   /// \brief Computes the Jacobian matrix of the map function
   /// \f$\frac{\partial\phi_x}{\partial v}(0)\f$
   /// \param x element of manifold \f$x\in\mathbb{M}\f$
   /// \return Matrix representing \f$\frac{\partial\phi_x}{\partial v}(0)\f$
   Eigen::MatrixXd diffRetractation(const ConstRefVec& x) const;
 
+  /// \brief Computes the Jacobian matrix of the map function as a sparse
+  /// matrix. Only the diagonal blocks of the submanifolds are stored, so that
+  /// the sparsity pattern does not depend on x.
+  /// \param out sparse matrix of size representationDim x tangentDim
+  /// \param x element of manifold \f$x\in\mathbb{M}\f$
+  void diffRetractation(SparseMat& out, const ConstRefVec& x) const;
+
   /// \brief Computes the product of a matrix in with the jacobian matrix of
   /// the map on point x.\n \f$ out = in*\frac{\partial\phi_x}{\partial v}(0)\f$
   /// \param out result of the operation
@@ -192,6 +230,40 @@ class MANIFOLDS_API Manifold : public RefCounter, public ValidManifold
   void applyDiffRetractation(RefMat out, const ConstRefMat& in,
                              const ConstRefVec& x) const;
 
+  /// \brief Sparse version of applyDiffRetractation, for sparse matrices in
+  /// column-major or row-major order. The product is computed with the sparse
+  /// block-diagonal Jacobian, restricted to the blocks of the submanifolds
+  /// whose columns of in hold nonzeros: the other blocks are not evaluated.
+  void applyDiffRetractation(SparseMat& out, const SparseMat& in,
+                             const ConstRefVec& x) const;
+  void applyDiffRetractation(SparseRowMat& out, const SparseRowMat& in,
+                             const ConstRefVec& x) const;
+
+  /// \brief External addition \f$ out = x \oplus v \f$ computed together
+  /// with the Jacobian matrix of the map function in v,
+  /// \f$ J = \frac{\partial\phi_x}{\partial v}(v) \f$.\n
+  /// The intermediate values of the retractation are reused for J, and out
+  /// can be x.
+  /// \param out output reference on element of the manifold
+  /// \param J output matrix of size representationDim x tangentDim
+  /// \param x element of the manifold \f$x\in\mathbb{M}\f$
+  /// \param v element of the tangent space of the manifold
+  void retractationWithJacobian(RefVec out, RefMat J, const ConstRefVec& x,
+                                const ConstRefVec& v) const;
+
+  /// \brief PseudoLog operation \f$ out = {Log}_x(y) \f$ computed together
+  /// with its derivatives with respect to x and y,
+  /// \f$ J_x = \frac{\partial Log_x(y)}{\partial x} \f$ and
+  /// \f$ J_y = \frac{\partial Log_x(y)}{\partial y} \f$.\n
+  /// The intermediate values of the pseudoLog are reused for the derivatives.
+  /// \param out output reference on element of the tangent space
+  /// \param Jx output matrix of size tangentDim x representationDim
+  /// \param Jy output matrix of size tangentDim x representationDim
+  /// \param x element of the manifold \f$x\in\mathbb{M}\f$
+  /// \param y element of the manifold \f$y\in\mathbb{M}\f$
+  void pseudoLogWithJacobian(RefVec out, RefMat Jx, RefMat Jy,
+                             const ConstRefVec& x, const ConstRefVec& y) const;
+
   /// \brief Computes the Jacobian matrix of the pseudoLog0 function
   /// \f$\frac{\partial\phi^{-1}_0}{\partial x}(x)\f$
   /// \param x element of manifold \f$x\in\mathbb{M}\f$
@@ -199,6 +271,13 @@ class MANIFOLDS_API Manifold : public RefCounter, public ValidManifold
   /// x}(x)\f$
   Eigen::MatrixXd diffPseudoLog0(const ConstRefVec& x) const;
 
+  /// \brief Computes the Jacobian matrix of the pseudoLog0 function as a
+  /// sparse matrix. Only the diagonal blocks of the submanifolds are stored,
+  /// so that the sparsity pattern does not depend on x.
+  /// \param out sparse matrix of size tangentDim x representationDim
+  /// \param x element of manifold \f$x\in\mathbb{M}\f$
+  void diffPseudoLog0(SparseMat& out, const ConstRefVec& x) const;
+
   /// \brief Computes the product of a matrix in with the jacobian matrix of
   /// the inverse map on point x.\n \f$ out =
   /// in*\frac{\partial\phi^{-1}_0}{\partial x}(x)\f$
@@ -208,6 +287,15 @@ class MANIFOLDS_API Manifold : public RefCounter, public ValidManifold
   void applyDiffPseudoLog0(RefMat out, const ConstRefMat& in,
                            const ConstRefVec& x) const;
 
+  /// \brief Sparse version of applyDiffPseudoLog0, for sparse matrices in
+  /// column-major or row-major order. The product is computed with the sparse
+  /// block-diagonal Jacobian, restricted to the blocks of the submanifolds
+  /// whose columns of in hold nonzeros: the other blocks are not evaluated.
+  void applyDiffPseudoLog0(SparseMat& out, const SparseMat& in,
+                           const ConstRefVec& x) const;
+  void applyDiffPseudoLog0(SparseRowMat& out, const SparseRowMat& in,
+                           const ConstRefVec& x) const;
+
   /// \brief applies a transport operation from point \f$x\in\mathcal{M}\f$ of
   /// direction \f$v\in T_x^\mathcal{M}\f$ on matrix in
   /// \param out result of the operation
@@ -349,14 +437,49 @@ class MANIFOLDS_API Manifold : public RefCounter, public ValidManifold
   virtual void createRandomPoint_(RefVec out, double coeff) const = 0;
   virtual void retractation_(RefVec out, const ConstRefVec& x,
                              const ConstRefVec& v) const = 0;
+  virtual void retractationBatch_(RefMat out, const ConstRefMat& X,
+                                  const ConstRefMat& V) const;
   virtual void pseudoLog_(RefVec out, const ConstRefVec& x,
                           const ConstRefVec& v) const = 0;
+  virtual void pseudoLogBatch_(RefMat out, const ConstRefMat& X,
+                               const ConstRefMat& Y) const;
   virtual void pseudoLog0_(RefVec out, const ConstRefVec& x) const = 0;
+  virtual void pseudoLog0Batch_(RefMat out, const ConstRefMat& X) const;
   virtual void setZero_(RefVec out) const = 0;
   virtual Eigen::MatrixXd diffRetractation_(const ConstRefVec& x) const = 0;
+  virtual void retractationWithJacobian_(RefVec out, RefMat J,
+                                         const ConstRefVec& x,
+                                         const ConstRefVec& v) const = 0;
+  virtual void pseudoLogWithJacobian_(RefVec out, RefMat Jx, RefMat Jy,
+                                      const ConstRefVec& x,
+                                      const ConstRefVec& y) const = 0;
   virtual void applyDiffRetractation_(RefMat out, const ConstRefMat& in,
                                       const ConstRefVec& x) const = 0;
   virtual Eigen::MatrixXd diffPseudoLog0_(const ConstRefVec& x) const = 0;
+  /// \brief Counts of the rows of a Jacobian that are needed, see isUsed
+  typedef std::vector<Index> UsedRows;
+
+  /// \brief Returns true if one of the rows [start, start + size) of the
+  /// Jacobian is needed. used[k] is the number of needed rows before row k, a
+  /// null used means that all the rows are.
+  static bool isUsed(const UsedRows* used, Index start, Index size);
+
+  /// \brief Appends to out the coefficients of diffRetractation(x), shifted by
+  /// startR rows and startT columns. The blocks whose rows are not used may
+  /// be skipped.\n
+  /// The default implementation stores the whole dense Jacobian.
+  virtual void diffRetractationTriplets_(std::vector<Triplet>& out,
+                                         const ConstRefVec& x, Index startR,
+                                         Index startT,
+                                         const UsedRows* used) const;
+  /// \brief Appends to out the coefficients of diffPseudoLog0(x), shifted by
+  /// startT rows and startR columns. The blocks whose rows are not used may
+  /// be skipped.\n
+  /// The default implementation stores the whole dense Jacobian.
+  virtual void diffPseudoLog0Triplets_(std::vector<Triplet>& out,
+                                       const ConstRefVec& x, Index startT,
+                                       Index startR,
+                                       const UsedRows* used) const;
   virtual void applyDiffPseudoLog0_(RefMat out, const ConstRefMat& in,
                                     const ConstRefVec& x) const = 0;
   virtual void applyTransport_(RefMat out, const ConstRefMat& in,
@@ -383,11 +506,28 @@ class MANIFOLDS_API Manifold : public RefCounter, public ValidManifold
   /// \brief tests if the manifold is locked, throwing an error if it is
   void testLock() const;
 
+  /// \brief Appends the coefficients of J to out, shifted by startRow rows and
+  /// startCol columns. Manifolds with fixed dimensions pass their fixed size
+  /// Jacobians, so that their triplets are built without a dense temporary.
+  template <typename Derived>
+  static void appendTriplets(std::vector<Triplet>& out,
+                             const Eigen::MatrixBase<Derived>& J,
+                             Index startRow, Index startCol);
+
 
   /// \brief a value used to identify different instances at runtime
   mutable long instanceId_;
 
  private:
+  /// \brief Implementations of the sparse applyDiffRetractation and
+  /// applyDiffPseudoLog0, for both storage orders of in
+  template <typename SparseType>
+  void applySparseDiffRetractation(SparseType& out, const SparseType& in,
+                                   const ConstRefVec& x) const;
+  template <typename SparseType>
+  void applySparseDiffPseudoLog0(SparseType& out, const SparseType& in,
+                                 const ConstRefVec& x) const;
+
   /// \brief Name of the Manifold
   std::string name_;
 
@@ -406,6 +546,16 @@ class MANIFOLDS_API Manifold : public RefCounter, public ValidManifold
 
   /// \brief if true, the manifold is locked
   mutable bool lock_;
+
+  /// \brief arena of the points created by this manifold, if any
+  PointArena* pointArena_;
+
+  /// \brief CartesianProduct and CartesianPower call the implementations of
+  /// their submanifolds directly
+  friend class CartesianProduct;
+  friend class CartesianPower;
+  /// \brief Point views walk sub points with getStart
+  friend class ConstPointView;
 };
 
 inline std::ostream& operator<<(std::ostream& os, const Manifold& m)
@@ -414,6 +564,22 @@ inline std::ostream& operator<<(std::ostream& os, const Manifold& m)
   return os;
 }
 
+inline bool Manifold::isUsed(const UsedRows* used, Index start, Index size)
+{
+  return !used || (*used)[static_cast<size_t>(start + size)] >
+                      (*used)[static_cast<size_t>(start)];
+}
+
+template <typename Derived>
+inline void Manifold::appendTriplets(std::vector<Triplet>& out,
+                                     const Eigen::MatrixBase<Derived>& J,
+                                     Index startRow, Index startCol)
+{
+  for (Index j = 0; j < J.cols(); ++j)
+    for (Index i = 0; i < J.rows(); ++i)
+      out.push_back(Triplet(startRow + i, startCol + j, J(i, j)));
+}
+
 template <int D>
 inline Segment Manifold::getView(RefVec val, size_t i) const
 {
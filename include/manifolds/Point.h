@@ -18,11 +18,18 @@
 #ifndef _MANIFOLDS_POINT_H_
 #define _MANIFOLDS_POINT_H_
 
+#include <type_traits>
+
 #include <manifolds/defs.h>
 
 namespace mnf
 {
 class Manifold;
+class PointArena;
+class ConstPointView;
+class PointView;
+template <typename Derived>
+class PointSum;
 
 class MANIFOLDS_API ConstSubPoint
 {
@@ -48,6 +55,9 @@ class MANIFOLDS_API ConstSubPoint
   // P[i] is equivalent to P(i).value()
   ConstSegment operator[](size_t i) const;
 
+  /// \brief Lightweight view on this point, see ConstPointView
+  ConstPointView view() const;
+
   const Manifold& getManifold() const;
   const Eigen::IOFormat& format() const;
 
@@ -67,7 +77,10 @@ class MANIFOLDS_API ConstSubPoint
   /// the
   /// constness in this class.
   RefVec value_;
-  mutable Eigen::IOFormat format_;
+  /// \internal Only set for points that are given a display format, so that
+  /// creating a sub point does not build the strings of an Eigen::IOFormat.
+  /// Null means mnf::defaultFormat.
+  mutable std::unique_ptr<Eigen::IOFormat> format_;
 
   friend inline std::ostream& operator<<(std::ostream& os,
                                          const ConstSubPoint& x);
@@ -105,17 +118,35 @@ class MANIFOLDS_API SubPoint : public ConstSubPoint
   {
     return ConstSubPoint::operator[](i);
   }
+
+  /// \brief Lightweight writable view on this point, see PointView
+  PointView view();
+  ConstPointView view() const;
 };
 
+/// \brief Storage of the value of a Point, taken from a PointArena or, if
+/// there is none, from the heap
 class MANIFOLDS_API PointMemory
 {
  protected:
-  PointMemory(Index size);
-  PointMemory(const ConstRefVec& v);
-  Eigen::VectorXd& getMem();
+  PointMemory(Index size, PointArena* arena);
+  PointMemory(const ConstRefVec& v, PointArena* arena);
+  /// \brief Takes over the buffer of other, which is left empty
+  PointMemory(PointMemory&& other) NOEXCEPT(true);
+  ~PointMemory();
+  Eigen::Map<Eigen::VectorXd> getMem();
+  /// \brief Exchanges the buffers of two memories
+  void swapMem(PointMemory& other) NOEXCEPT(true);
 
  private:
-  Eigen::VectorXd mem_;
+  PointMemory(const PointMemory&);
+  PointMemory& operator=(const PointMemory&);
+
+  void allocate();
+
+  double* mem_;
+  Index size_;
+  PointArena* arena_;
 };
 
 class MANIFOLDS_API Point : public PointMemory, public SubPoint
@@ -126,13 +157,25 @@ class MANIFOLDS_API Point : public PointMemory, public SubPoint
 
  public:
   Point(const Point& other);
+  /// \brief Takes over the memory of other without allocating. other is left
+  /// empty and can only be destroyed or assigned by move. Moving from an
+  /// empty point gives an empty point.
+  Point(Point&& other) NOEXCEPT(true);
   Point(const ConstSubPoint& other);
+  Point(const ConstPointView& other);
 
   /// \internal For now, we keep operations on Point only. ConstSubPoint and
   /// SubPoint
   /// are only intended for memory read/write, not Manifold operations.
   Point& increment(const ConstRefVec& v);
   Point& operator=(const Point& x);
+  /// \brief Exchanges the memory of the two points, that must have the same
+  /// dimensions, without copying their values. x cannot be empty.
+  Point& operator=(Point&& x);
+  /// \brief Evaluates the retractation x + v directly in the memory of this
+  /// point. x can be this point.
+  template <typename Derived>
+  Point& operator=(const PointSum<Derived>& sum);
 
   /// \brief Computes a new point that is the result of a retractation of v
   /// at the current point x. \f$ out = \phi_x(v) \f$
@@ -201,11 +244,145 @@ class MANIFOLDS_API Point : public PointMemory, public SubPoint
 
   virtual const Point& format(const Eigen::IOFormat& fmt) const;
 
+ private:
+  /// \internal Points value_ to the current memory
+  void bindMem();
+
   friend class Manifold;
 };
 
-MANIFOLDS_API Point operator+(const Point& x, const ConstRefVec& v);
-MANIFOLDS_API Eigen::VectorXd operator-(const Point& x, const Point& y);
+namespace utils
+{
+/// \internal Returns a buffer of the calling thread in which the vector
+/// expressions of PointSum are evaluated
+MANIFOLDS_API Eigen::Map<Eigen::VectorXd> pointExpressionBuffer(Index size);
+}
+
+/// \brief Lazy expression of the retractation x + v of a vector expression v
+/// at a point x.\n
+/// Nothing is computed until the expression is assigned to a Point, converted
+/// to a new Point or evaluated with evalTo. Vectors with direct access are
+/// passed as is to the retractation, other expressions (e.g. a*v1 + b*v2) are
+/// evaluated in a per-thread buffer, so that no memory is allocated.\n
+/// x + v used to return a Point: code calling Point methods on the result,
+/// such as (x + v).value(), must now call eval() first.\n
+/// The expression keeps a reference on x and on plain vectors v, and copies
+/// the lighter expressions such as a*v1 + b*v2. It can be stored with auto
+/// as long as x and the vectors it refers to are alive and unchanged.
+template <typename Derived>
+class PointSum
+{
+ public:
+  PointSum(const Point& x, const Eigen::MatrixBase<Derived>& v)
+      : x_(x), v_(v.derived())
+  {
+  }
+
+  /// \brief Creates a new Point equal to x + v
+  operator Point() const { return eval(); }
+
+  /// \brief Creates a new Point equal to x + v
+  Point eval() const
+  {
+    Point out(x_);
+    evalTo(out.value());
+    return out;
+  }
+
+  /// \brief Writes the value of x + v in out, that can alias x
+  void evalTo(RefVec out) const
+  {
+    // Same condition as for an Eigen::Ref to bind without copy
+    const bool direct = (int(Derived::Flags) & Eigen::DirectAccessBit) &&
+                        int(Derived::InnerStrideAtCompileTime) == 1;
+    if (direct)
+    {
+      x_.retractation(out, v_);
+    }
+    else
+    {
+      Eigen::Map<Eigen::VectorXd> v = utils::pointExpressionBuffer(v_.size());
+      v = v_;
+      x_.retractation(out, v);
+    }
+  }
+
+  const Point& point() const { return x_; }
+
+ private:
+  /// \brief Plain vectors are kept by reference, expressions by value so
+  /// that the temporaries they are made of can be destroyed
+  typedef typename std::conditional<
+      std::is_base_of<Eigen::PlainObjectBase<Derived>, Derived>::value,
+      const Derived&, const Derived>::type VectorNested;
+
+  const Point& x_;
+  VectorNested v_;
+};
+
+class PointDifference;
+}
+
+namespace Eigen
+{
+namespace internal
+{
+template <>
+struct traits<mnf::PointDifference>
+{
+  typedef Eigen::VectorXd ReturnType;
+};
+}
+}
+
+namespace mnf
+{
+/// \brief Lazy expression of the pseudoLog x - y = Log_y(x) of two points.\n
+/// It is an Eigen::ReturnByValue: assigning it to a vector evaluates the
+/// pseudoLog directly in that vector, and eval() returns a new vector. x - y
+/// used to return an Eigen::VectorXd.\n
+/// The expression keeps references on x and y: it can be stored with auto as
+/// long as they are alive and unchanged.
+class PointDifference : public Eigen::ReturnByValue<PointDifference>
+{
+ public:
+  PointDifference(const Point& x, const Point& y) : x_(x), y_(y) {}
+
+  template <typename Dest>
+  void evalTo(Dest& dst) const
+  {
+    y_.pseudoLog(dst, x_);
+  }
+
+  Index rows() const { return y_.getTangentDimM(); }
+  Index cols() const { return 1; }
+
+ private:
+  const Point& x_;
+  const Point& y_;
+};
+
+template <typename Derived>
+inline Point& Point::operator=(const PointSum<Derived>& sum)
+{
+  // The dimensions are checked by the retractation
+  sum.evalTo(this->value_);
+  return *this;
+}
+
+/// \brief Retractation of v at x, see PointSum
+template <typename Derived>
+inline PointSum<Derived> operator+(const Point& x,
+                                   const Eigen::MatrixBase<Derived>& v)
+{
+  return PointSum<Derived>(x, v);
+}
+
+/// \brief PseudoLog of x at y, see PointDifference
+inline PointDifference operator-(const Point& x, const Point& y)
+{
+  return PointDifference(x, y);
+}
 
 inline std::ostream& operator<<(std::ostream& os, const ConstSubPoint& x)
 {
@@ -0,0 +1,89 @@
+// Copyright (c) 2015 CNRS
+// Authors: Stanislas Brossette, Adrien Escande
+
+// This file is part of manifolds
+// manifolds is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+
+// manifolds is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// manifolds. If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef _MANIFOLDS_POINT_ARENA_H_
+#define _MANIFOLDS_POINT_ARENA_H_
+
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <manifolds/defs.h>
+
+namespace mnf
+{
+/// \brief Pool of memory from which a Manifold can take the storage of the
+/// points it creates (see Manifold::setPointArena).\n
+/// Blocks are grouped in size classes of powers of two. A freed block is kept
+/// in the free list of its class and given back by the next allocation of the
+/// same class. New blocks are carved out of large slabs, so that the system
+/// allocator is only called when a slab is full.\n
+/// An arena is not thread-safe: threads that create points concurrently
+/// should use one arena each. It must outlive the points allocated in it.
+class MANIFOLDS_API PointArena
+{
+ public:
+  /// \param slabSize number of doubles of the slabs
+  PointArena(size_t slabSize = 4096);
+  ~PointArena();
+
+  /// \brief Returns a block of at least size doubles
+  double* allocate(Index size);
+
+  /// \brief Gives back block p, obtained by allocate(size), to the arena
+  void deallocate(double* p, Index size);
+
+  /// \brief Makes the whole memory of the arena available again, without
+  /// releasing it to the system. Typically called once per solver iteration.
+  /// No block of the arena must be in use.
+  void reset();
+
+  /// \brief Number of blocks currently in use
+  size_t liveBlocks() const;
+
+  /// \brief Number of slabs allocated from the system
+  size_t numberOfSlabs() const;
+
+ private:
+  PointArena(const PointArena&);
+  PointArena& operator=(const PointArena&);
+
+  /// \brief Index k of the smallest class with blocks of 2^k >= size doubles
+  static size_t sizeClass(Index size);
+
+  Eigen::aligned_allocator<double> allocator_;
+  size_t slabSize_;
+
+  /// \brief Slabs allocated so far, with their size
+  std::vector<std::pair<double*, size_t> > slabs_;
+
+  /// \brief Slab in which new blocks are carved, and first free position in it
+  size_t currentSlab_;
+  size_t offset_;
+
+  /// \brief Freed blocks of each size class
+  std::vector<std::vector<double*> > freeLists_;
+
+  size_t liveBlocks_;
+};
+
+inline size_t PointArena::liveBlocks() const { return liveBlocks_; }
+
+inline size_t PointArena::numberOfSlabs() const { return slabs_.size(); }
+}
+
+#endif  //_MANIFOLDS_POINT_ARENA_H_
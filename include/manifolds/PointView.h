@@ -0,0 +1,100 @@
+// Copyright (c) 2015 CNRS
+// Authors: Stanislas Brossette, Adrien Escande
+
+// This file is part of manifolds
+// manifolds is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+
+// manifolds is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// manifolds. If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef _MANIFOLDS_POINT_VIEW_H_
+#define _MANIFOLDS_POINT_VIEW_H_
+
+#include <manifolds/defs.h>
+#include <manifolds/Manifold.h>
+
+namespace mnf
+{
+/// \brief Non-owning, read-only view on the value of a point.\n
+/// A view is only a pointer on a manifold and a pointer on data: it is
+/// trivially copyable, does not register on the manifold and holds no
+/// formatting state, which makes it suitable to walk the sub-points of a
+/// point in hot loops. The manifold and the data must outlive the view.
+class ConstPointView
+{
+ public:
+  ConstPointView(const Manifold& M, const double* data)
+      : manifold_(&M), data_(data)
+  {
+  }
+
+  /// \brief Value of the point
+  Eigen::Map<const Eigen::VectorXd> value() const
+  {
+    return Eigen::Map<const Eigen::VectorXd>(data_,
+                                             manifold_->representationDim());
+  }
+
+  /// \brief View on the i-th sub point
+  ConstPointView operator()(size_t i) const
+  {
+    return ConstPointView((*manifold_)(i), data_ + start(i));
+  }
+
+  /// \brief Value of the i-th sub point. V[i] is equivalent to V(i).value()
+  Eigen::Map<const Eigen::VectorXd> operator[](size_t i) const
+  {
+    return operator()(i).value();
+  }
+
+  const Manifold& getManifold() const { return *manifold_; }
+  const double* data() const { return data_; }
+
+ protected:
+  /// \brief Start of the i-th sub point in the data
+  Index start(size_t i) const { return manifold_->getStart<R>(i); }
+
+  const Manifold* manifold_;
+  const double* data_;
+};
+
+/// \brief Non-owning, writable view on the value of a point. See
+/// ConstPointView.
+class PointView : public ConstPointView
+{
+ public:
+  PointView(const Manifold& M, double* data) : ConstPointView(M, data) {}
+
+  /// \brief Value of the point
+  Eigen::Map<Eigen::VectorXd> value() const
+  {
+    return Eigen::Map<Eigen::VectorXd>(data(), manifold_->representationDim());
+  }
+
+  /// \brief View on the i-th sub point
+  PointView operator()(size_t i) const
+  {
+    return PointView((*manifold_)(i), data() + start(i));
+  }
+
+  /// \brief Value of the i-th sub point. V[i] is equivalent to V(i).value()
+  Eigen::Map<Eigen::VectorXd> operator[](size_t i) const
+  {
+    return operator()(i).value();
+  }
+
+  /// \internal The constness of the data is only honored by ConstPointView,
+  /// as in ConstSubPoint.
+  double* data() const { return const_cast<double*>(data_); }
+};
+}
+
+#endif  //_MANIFOLDS_POINT_VIEW_H_
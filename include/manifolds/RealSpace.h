@@ -60,16 +60,35 @@ class MANIFOLDS_API RealSpace : public Manifold
   virtual void createRandomPoint_(RefVec out, double coeff) const;
   virtual void retractation_(RefVec out, const ConstRefVec& x,
                              const ConstRefVec& v) const;
+  virtual void retractationBatch_(RefMat out, const ConstRefMat& X,
+                                  const ConstRefMat& V) const;
   virtual void pseudoLog_(RefVec out, const ConstRefVec& x,
                           const ConstRefVec& y) const;
+  virtual void pseudoLogBatch_(RefMat out, const ConstRefMat& X,
+                               const ConstRefMat& Y) const;
   virtual void pseudoLog0_(RefVec out, const ConstRefVec& x) const;
+  virtual void pseudoLog0Batch_(RefMat out, const ConstRefMat& X) const;
   virtual void setZero_(RefVec out) const;
   virtual Eigen::MatrixXd diffRetractation_(const ConstRefVec& x) const;
+  virtual void retractationWithJacobian_(RefVec out, RefMat J,
+                                         const ConstRefVec& x,
+                                         const ConstRefVec& v) const;
+  virtual void pseudoLogWithJacobian_(RefVec out, RefMat Jx, RefMat Jy,
+                                      const ConstRefVec& x,
+                                      const ConstRefVec& y) const;
   virtual void applyDiffRetractation_(RefMat out, const ConstRefMat& in,
                                       const ConstRefVec& x) const;
   virtual Eigen::MatrixXd diffPseudoLog0_(const ConstRefVec& x) const;
   virtual void applyDiffPseudoLog0_(RefMat out, const ConstRefMat& in,
                                     const ConstRefVec& x) const;
+  virtual void diffRetractationTriplets_(std::vector<Triplet>& out,
+                                         const ConstRefVec& x, Index startR,
+                                         Index startT,
+                                         const UsedRows* used) const;
+  virtual void diffPseudoLog0Triplets_(std::vector<Triplet>& out,
+                                       const ConstRefVec& x, Index startT,
+                                       Index startR,
+                                       const UsedRows* used) const;
   virtual void applyTransport_(RefMat out, const ConstRefMat& in,
                                const ConstRefVec& x,
                                const ConstRefVec& v) const;
@@ -89,10 +108,31 @@ class MANIFOLDS_API RealSpace : public Manifold
 
   virtual std::shared_ptr<Manifold> getNewCopy_() const;
 
+  template <typename... Ms>
+  friend class StaticCartesianProduct;
+
  private:
   Eigen::VectorXd typicalMagnitude_;
   Eigen::VectorXd trustMagnitude_;
 };
+
+/// \brief RealSpace whose dimension N is known at compile time, as required
+/// by StaticCartesianProduct
+template <int N>
+class FixedRealSpace : public RealSpace
+{
+ public:
+  FixedRealSpace() : RealSpace(N) {}
+  FixedRealSpace(double magnitude) : RealSpace(N, magnitude) {}
+  FixedRealSpace(const ConstRefVec& magnitude) : RealSpace(N, magnitude) {}
+
+ protected:
+  virtual std::shared_ptr<Manifold> getNewCopy_() const
+  {
+    std::shared_ptr<FixedRealSpace<N> > copy(new FixedRealSpace<N>(*this));
+    return copy;
+  }
+};
 }
 
 #endif  //_MANIFOLDS_REAL_SPACE_H_
@@ -18,25 +18,39 @@
 #ifndef _MANIFOLDS_REF_COUNTER_H_
 #define _MANIFOLDS_REF_COUNTER_H_
 
+#ifdef MNF_ATOMIC_REF_COUNTER
+#include <atomic>
+#endif
+
 #include <manifolds/defs.h>
 #include <manifolds/Point.h>
 #include <manifolds/mnf_assert.h>
 
-// The operator version of noexcept is available starting Visual Studio 2015
-// https://msdn.microsoft.com/en-us/library/dn956976.aspx
-#if defined(_MSC_FULL_VER) && _MSC_VER < 1900
-#define NOEXCEPT(x)
-#else
-#define NOEXCEPT(x) noexcept(x)
-#endif
-
 namespace mnf
 {
 /// \brief object containing a counter and that cannot be destroyed if the
-/// counter is not at 0.
+/// counter is not at 0.\n
+/// The counting depends on the build configuration:
+/// - by default, the counter is a plain int, and points of a same manifold
+/// must not be created or destroyed concurrently.
+/// - with MNF_ATOMIC_REF_COUNTER, the counter is an atomic updated with
+/// relaxed operations, so that several threads can create and destroy points
+/// of a shared manifold.
+/// - with MNF_NO_REF_COUNTER, nothing is counted and the check that a
+/// manifold outlives its points is removed.
 class RefCounter
 {
  public:
+#ifdef MNF_NO_REF_COUNTER
+  RefCounter() {}
+
+  RefCounter(const RefCounter&) {}
+
+ protected:
+  void incrementRefCounter() const {}
+  void decrementRefCounter() const {}
+
+#else
   RefCounter() : count_(0) {}
 
   RefCounter(const RefCounter&) : count_(0) {}
@@ -45,21 +59,48 @@ class RefCounter
   // noexcet to false allows it.
   ~RefCounter() NOEXCEPT(false)
   {
-    mnf_assert(count_ == 0 &&
+    mnf_assert(refCount() == 0 &&
                "You cannot destroy this manifold because some points still "
                "depend on it");
   }
 
  protected:
+#ifdef MNF_ATOMIC_REF_COUNTER
+  void incrementRefCounter() const
+  {
+    count_.fetch_add(1, std::memory_order_relaxed);
+  }
+  void decrementRefCounter() const
+  {
+    int previous = count_.fetch_sub(1, std::memory_order_relaxed);
+    mnf_assert(previous > 0 && "You cannot decrement when no point exist");
+    (void)previous;
+  }
+  int refCount() const { return count_.load(std::memory_order_relaxed); }
+#else
   void incrementRefCounter() const { count_++; }
   void decrementRefCounter() const
   {
     mnf_assert(count_ > 0 && "You cannot decrement when no point exist");
     count_--;
   }
+  int refCount() const { return count_; }
+#endif
 
  private:
+#ifdef MNF_ATOMIC_REF_COUNTER
+  mutable std::atomic<int> count_;
+#else
   mutable int count_;
+#endif
+#endif  // MNF_NO_REF_COUNTER
+
+ public:
+  // The points of a manifold stay its own when another manifold is assigned
+  // to it
+  RefCounter& operator=(const RefCounter&) { return *this; }
+
+ private:
   friend void ConstSubPoint::registerPoint();
   friend void ConstSubPoint::unregisterPoint();
 };
@@ -36,6 +36,11 @@ class MANIFOLDS_API ReusableTemporaryMap
   Eigen::Map<Eigen::MatrixXd, Eigen::Aligned> getMap(Eigen::DenseIndex m,
                                                      Eigen::DenseIndex n);
 
+  /// \brief Returns the map owned by the calling thread.\n
+  /// Each thread gets its own buffer, allocated at its first call, so that
+  /// const methods working in it can be called concurrently without locks.
+  static ReusableTemporaryMap& ofCurrentThread();
+
  private:
   ReusableTemporaryMap& operator=(
       const ReusableTemporaryMap&);  // We forbid copy
@@ -31,6 +31,31 @@ namespace mnf
 class MANIFOLDS_API S2 : public Manifold
 {
  public:
+  /// \brief Transport from a point x to its retractation y along v, see
+  /// S2::transport.\n
+  /// It stores y and the rotation R bringing x on y, so that several
+  /// transports with the same (x, v) compute them only once.
+  class MANIFOLDS_API Transport
+  {
+   public:
+    /// \brief the retractation y of v at x
+    const Eigen::Vector3d& target() const { return y_; }
+    /// \brief the rotation R such that y = R x
+    const Eigen::Matrix3d& rotation() const { return R_; }
+
+    /// \brief out = R*in, see Manifold::applyTransport
+    void applyTransport(RefMat out, const ConstRefMat& in) const;
+    /// \brief out = R^T*in, see Manifold::applyInvTransport
+    void applyInvTransport(RefMat out, const ConstRefMat& in) const;
+    /// \brief out = in*R^T, see Manifold::applyInvTransportOnTheRight
+    void applyInvTransportOnTheRight(RefMat out, const ConstRefMat& in) const;
+
+   private:
+    friend class S2;
+    Eigen::Vector3d y_;
+    Eigen::Matrix3d R_;
+  };
+
   S2();
   S2(double trustMagnitude);
   S2(const ConstRefVec& trustMagnitude);
@@ -60,6 +85,9 @@ class MANIFOLDS_API S2 : public Manifold
   void rand(RefVec out) const;
   void randVec(RefVec out, const ConstRefVec& x) const;
   Eigen::Vector3d randVec(const ConstRefVec& x) const;
+  /// \brief Computes the retractation of v at x and the rotation of the
+  /// transport from x to this point, to be applied several times
+  Transport transport(const ConstRefVec& x, const ConstRefVec& v) const;
   virtual bool isElementary() const;
   virtual bool isSameTopology(const Manifold& other) const;
   virtual long getTypeId() const;
@@ -71,16 +99,34 @@ class MANIFOLDS_API S2 : public Manifold
   virtual void getIdentityOnTxM_(RefMat out, const ConstRefVec& x) const;
   virtual void retractation_(RefVec out, const ConstRefVec& x,
                              const ConstRefVec& v) const;
+  virtual void retractationBatch_(RefMat out, const ConstRefMat& X,
+                                  const ConstRefMat& V) const;
   virtual void pseudoLog_(RefVec out, const ConstRefVec& x,
                           const ConstRefVec& y) const;
+  virtual void pseudoLogBatch_(RefMat out, const ConstRefMat& X,
+                               const ConstRefMat& Y) const;
   virtual void pseudoLog0_(RefVec out, const ConstRefVec& x) const;
   virtual void setZero_(RefVec out) const;
   virtual Eigen::MatrixXd diffRetractation_(const ConstRefVec& x) const;
+  virtual void retractationWithJacobian_(RefVec out, RefMat J,
+                                         const ConstRefVec& x,
+                                         const ConstRefVec& v) const;
+  virtual void pseudoLogWithJacobian_(RefVec out, RefMat Jx, RefMat Jy,
+                                      const ConstRefVec& x,
+                                      const ConstRefVec& y) const;
   virtual void applyDiffRetractation_(RefMat out, const ConstRefMat& in,
                                       const ConstRefVec& x) const;
   virtual Eigen::MatrixXd diffPseudoLog0_(const ConstRefVec& x) const;
   virtual void applyDiffPseudoLog0_(RefMat out, const ConstRefMat& in,
                                     const ConstRefVec& x) const;
+  virtual void diffRetractationTriplets_(std::vector<Triplet>& out,
+                                         const ConstRefVec& x, Index startR,
+                                         Index startT,
+                                         const UsedRows* used) const;
+  virtual void diffPseudoLog0Triplets_(std::vector<Triplet>& out,
+                                       const ConstRefVec& x, Index startT,
+                                       Index startR,
+                                       const UsedRows* used) const;
   virtual void applyTransport_(RefMat out, const ConstRefMat& in,
                                const ConstRefVec& x,
                                const ConstRefVec& v) const;
@@ -100,7 +146,22 @@ class MANIFOLDS_API S2 : public Manifold
 
   virtual std::shared_ptr<Manifold> getNewCopy_() const;
 
+  /// \brief Version of transport without the checks on x and v
+  Transport transport_(const ConstRefVec& x, const ConstRefVec& v) const;
+
+  /// \brief Jacobian of pseudoLog0 at x, that is of the logarithm taken at
+  /// the zero point (1, 0, 0)
+  void diffLogarithm0(Eigen::Matrix3d& J, const ConstRefVec& x) const;
+
+  template <typename... Ms>
+  friend class StaticCartesianProduct;
+
  private:
+  /// \brief Allocates the scratch memory of the constructing thread, so that
+  /// its first transport does not allocate. The other threads still allocate
+  /// theirs on their first transport.
+  static void warmUpScratchMemory();
+
   Eigen::Vector3d typicalMagnitude_;
   Eigen::Vector3d trustMagnitude_;
 };
@@ -58,16 +58,35 @@ class SO3 : public Manifold
   virtual void forceOnM_(RefVec out, const ConstRefVec& in) const;
   virtual void retractation_(RefVec out, const ConstRefVec& x,
                              const ConstRefVec& v) const;
+  virtual void retractationBatch_(RefMat out, const ConstRefMat& X,
+                                  const ConstRefMat& V) const;
   virtual void pseudoLog_(RefVec out, const ConstRefVec& x,
                           const ConstRefVec& y) const;
+  virtual void pseudoLogBatch_(RefMat out, const ConstRefMat& X,
+                               const ConstRefMat& Y) const;
   virtual void pseudoLog0_(RefVec out, const ConstRefVec& x) const;
+  virtual void pseudoLog0Batch_(RefMat out, const ConstRefMat& X) const;
   virtual void setZero_(RefVec out) const;
   virtual Eigen::MatrixXd diffRetractation_(const ConstRefVec& x) const;
+  virtual void retractationWithJacobian_(RefVec out, RefMat J,
+                                         const ConstRefVec& x,
+                                         const ConstRefVec& v) const;
+  virtual void pseudoLogWithJacobian_(RefVec out, RefMat Jx, RefMat Jy,
+                                      const ConstRefVec& x,
+                                      const ConstRefVec& y) const;
   virtual void applyDiffRetractation_(RefMat out, const ConstRefMat& in,
                                       const ConstRefVec& x) const;
   virtual Eigen::MatrixXd diffPseudoLog0_(const ConstRefVec& x) const;
   virtual void applyDiffPseudoLog0_(RefMat out, const ConstRefMat& in,
                                     const ConstRefVec& x) const;
+  virtual void diffRetractationTriplets_(std::vector<Triplet>& out,
+                                         const ConstRefVec& x, Index startR,
+                                         Index startT,
+                                         const UsedRows* used) const;
+  virtual void diffPseudoLog0Triplets_(std::vector<Triplet>& out,
+                                       const ConstRefVec& x, Index startT,
+                                       Index startR,
+                                       const UsedRows* used) const;
   virtual void applyTransport_(RefMat out, const ConstRefMat& in,
                                const ConstRefVec& x,
                                const ConstRefVec& v) const;
@@ -85,10 +104,12 @@ class SO3 : public Manifold
                            const ConstRefVec& x) const;
   virtual void getIdentityOnTxM_(RefMat out, const ConstRefVec& x) const;
   virtual void limitMap_(RefVec out) const;
-  mutable ReusableTemporaryMap bufferMap_;
 
   virtual std::shared_ptr<Manifold> getNewCopy_() const;
 
+  template <typename... Ms>
+  friend class StaticCartesianProduct;
+
  private:
   Eigen::Vector3d typicalMagnitude_;
   Eigen::Vector3d trustMagnitude_;
@@ -102,6 +123,9 @@ inline SO3<Map>::SO3()
   name() = "SO3";
   setTypicalMagnitude(Eigen::Vector3d::Constant(M_PI));
   setTrustMagnitude(Eigen::Vector3d::Constant(M_PI));
+  // Allocates the scratch memory of this thread now rather than in the first
+  // call to applyDiffRetractation or applyDiffPseudoLog0
+  ReusableTemporaryMap::ofCurrentThread();
 }
 template <typename Map>
 inline SO3<Map>::SO3(double magnitude)
@@ -110,6 +134,7 @@ inline SO3<Map>::SO3(double magnitude)
   name() = "SO3";
   setTypicalMagnitude(Eigen::Vector3d::Constant(magnitude));
   setTrustMagnitude(Eigen::Vector3d::Constant(magnitude));
+  ReusableTemporaryMap::ofCurrentThread();
 }
 template <typename Map>
 inline SO3<Map>::SO3(const ConstRefVec& magnitude)
@@ -119,6 +144,7 @@ inline SO3<Map>::SO3(const ConstRefVec& magnitude)
   name() = "SO3";
   setTypicalMagnitude(magnitude);
   setTrustMagnitude(magnitude);
+  ReusableTemporaryMap::ofCurrentThread();
 }
 
 template <typename Map>
@@ -179,6 +205,13 @@ inline void SO3<Map>::retractation_(RefVec out, const ConstRefVec& x,
   Map::retractation_(out, x, v);
 }
 
+template <typename Map>
+inline void SO3<Map>::retractationBatch_(RefMat out, const ConstRefMat& X,
+                                         const ConstRefMat& V) const
+{
+  Map::retractationBatch_(out, X, V);
+}
+
 template <typename Map>
 inline void SO3<Map>::pseudoLog_(RefVec out, const ConstRefVec& x,
                                  const ConstRefVec& y) const
@@ -192,6 +225,19 @@ inline void SO3<Map>::pseudoLog0_(RefVec out, const ConstRefVec& x) const
   Map::pseudoLog0_(out, x);
 }
 
+template <typename Map>
+inline void SO3<Map>::pseudoLogBatch_(RefMat out, const ConstRefMat& X,
+                                      const ConstRefMat& Y) const
+{
+  Map::pseudoLogBatch_(out, X, Y);
+}
+
+template <typename Map>
+inline void SO3<Map>::pseudoLog0Batch_(RefMat out, const ConstRefMat& X) const
+{
+  Map::pseudoLog0Batch_(out, X);
+}
+
 template <typename Map>
 inline void SO3<Map>::setZero_(RefVec out) const
 {
@@ -204,11 +250,28 @@ inline Eigen::MatrixXd SO3<Map>::diffRetractation_(const ConstRefVec& x) const
   return Map::diffRetractation_(x);
 }
 
+template <typename Map>
+inline void SO3<Map>::retractationWithJacobian_(RefVec out, RefMat J,
+                                               const ConstRefVec& x,
+                                               const ConstRefVec& v) const
+{
+  Map::retractationWithJacobian_(out, J, x, v);
+}
+
+template <typename Map>
+inline void SO3<Map>::pseudoLogWithJacobian_(RefVec out, RefMat Jx, RefMat Jy,
+                                            const ConstRefVec& x,
+                                            const ConstRefVec& y) const
+{
+  Map::pseudoLogWithJacobian_(out, Jx, Jy, x, y);
+}
+
 template <typename Map>
 inline void SO3<Map>::applyDiffRetractation_(RefMat out, const ConstRefMat& in,
                                              const ConstRefVec& x) const
 {
-  Map::applyDiffRetractation_(out, in, x, bufferMap_);
+  Map::applyDiffRetractation_(out, in, x,
+                              ReusableTemporaryMap::ofCurrentThread());
 }
 
 template <typename Map>
@@ -221,7 +284,30 @@ template <typename Map>
 inline void SO3<Map>::applyDiffPseudoLog0_(RefMat out, const ConstRefMat& in,
                                            const ConstRefVec& x) const
 {
-  Map::applyDiffPseudoLog0_(out, in, x, bufferMap_);
+  Map::applyDiffPseudoLog0_(out, in, x,
+                            ReusableTemporaryMap::ofCurrentThread());
+}
+
+template <typename Map>
+inline void SO3<Map>::diffRetractationTriplets_(std::vector<Triplet>& out,
+                                                const ConstRefVec& x,
+                                                Index startR,
+                                                Index startT,
+                                                const UsedRows* used) const
+{
+  if (!isUsed(used, startR, Map::OutputDim_)) return;
+  appendTriplets(out, Map::diffRetractation_(x), startR, startT);
+}
+
+template <typename Map>
+inline void SO3<Map>::diffPseudoLog0Triplets_(std::vector<Triplet>& out,
+                                              const ConstRefVec& x,
+                                              Index startT,
+                                              Index startR,
+                                              const UsedRows* used) const
+{
+  if (!isUsed(used, startT, Map::InputDim_)) return;
+  appendTriplets(out, Map::diffPseudoLog0_(x), startT, startR);
 }
 
 template <typename Map>
@@ -0,0 +1,768 @@
+// Copyright (c) 2015 CNRS
+// Authors: Stanislas Brossette, Adrien Escande
+
+// This file is part of manifolds
+// manifolds is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+
+// manifolds is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// manifolds. If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef _MANIFOLDS_STATIC_CARTESIAN_PRODUCT_H_
+#define _MANIFOLDS_STATIC_CARTESIAN_PRODUCT_H_
+
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+
+#include <manifolds/defs.h>
+#include <manifolds/CartesianProduct.h>
+#include <manifolds/RealSpace.h>
+#include <manifolds/S2.h>
+#include <manifolds/SO3.h>
+#include <manifolds/mnf_assert.h>
+
+namespace mnf
+{
+/// \brief Compile-time dimensions of a manifold type. It needs to be
+/// specialized for every type used in a StaticCartesianProduct.
+template <typename M>
+struct StaticDimensions;
+
+template <int N>
+struct StaticDimensions<FixedRealSpace<N> >
+{
+  enum
+  {
+    Dim = N,
+    TangentDim = N,
+    RepresentationDim = N
+  };
+};
+
+template <>
+struct StaticDimensions<S2>
+{
+  enum
+  {
+    Dim = 2,
+    TangentDim = 3,
+    RepresentationDim = 3
+  };
+};
+
+template <typename Map>
+struct StaticDimensions<SO3<Map> >
+{
+  enum
+  {
+    Dim = 3,
+    TangentDim = Map::InputDim_,
+    RepresentationDim = Map::OutputDim_
+  };
+};
+
+template <typename... Ms>
+class StaticCartesianProduct;
+
+namespace internal
+{
+/// \brief Sum of the dimensions of the manifolds Ms
+template <typename... Ms>
+struct StaticDimensionsSum
+{
+  enum
+  {
+    Dim = 0,
+    TangentDim = 0,
+    RepresentationDim = 0
+  };
+};
+
+template <typename M, typename... Ms>
+struct StaticDimensionsSum<M, Ms...>
+{
+  enum
+  {
+    Dim = StaticDimensions<M>::Dim + StaticDimensionsSum<Ms...>::Dim,
+    TangentDim = StaticDimensions<M>::TangentDim +
+                 StaticDimensionsSum<Ms...>::TangentDim,
+    RepresentationDim = StaticDimensions<M>::RepresentationDim +
+                        StaticDimensionsSum<Ms...>::RepresentationDim
+  };
+};
+
+/// \brief Start indices of the I-th manifold of Ms in the tangent and
+/// representation spaces
+template <size_t I, typename... Ms>
+struct StaticStart;
+
+template <typename M, typename... Ms>
+struct StaticStart<0, M, Ms...>
+{
+  enum
+  {
+    T = 0,
+    R = 0
+  };
+};
+
+template <size_t I, typename M, typename... Ms>
+struct StaticStart<I, M, Ms...>
+{
+  enum
+  {
+    T = StaticDimensions<M>::TangentDim + StaticStart<I - 1, Ms...>::T,
+    R = StaticDimensions<M>::RepresentationDim + StaticStart<I - 1, Ms...>::R
+  };
+};
+}
+
+template <typename... Ms>
+struct StaticDimensions<StaticCartesianProduct<Ms...> >
+    : public internal::StaticDimensionsSum<Ms...>
+{
+};
+
+/// \brief Cartesian product whose submanifolds types, and thus dimensions and
+/// start indices, are known at compile time.\n
+/// It behaves as a CartesianProduct, but the map operations are unrolled at
+/// compile time on fixed-size segments and call the submanifolds
+/// implementations directly, without virtual dispatch nor the checks of the
+/// public Manifold methods.\n
+/// Each type of Ms must specialize StaticDimensions, e.g.
+/// StaticCartesianProduct<FixedRealSpace<3>, SO3<ExpMapQuaternion>,
+/// FixedRealSpace<6> >
+template <typename... Ms>
+class StaticCartesianProduct : public CartesianProduct
+{
+ public:
+  enum
+  {
+    Dim = internal::StaticDimensionsSum<Ms...>::Dim,
+    TangentDim = internal::StaticDimensionsSum<Ms...>::TangentDim,
+    RepresentationDim = internal::StaticDimensionsSum<Ms...>::RepresentationDim
+  };
+
+  /// \brief Constructor of the product of default constructed submanifolds
+  StaticCartesianProduct();
+
+  /// \brief Constructor of the product of copies of \a m
+  explicit StaticCartesianProduct(const Ms&... m);
+
+ protected:
+  /// \brief The submanifolds are fixed by the template parameters: the
+  /// product is locked at construction and cannot be multiplied
+  virtual void testMultiply() const;
+
+  virtual void forceOnM_(RefVec out, const ConstRefVec& in) const;
+  virtual void retractation_(RefVec out, const ConstRefVec& x,
+                             const ConstRefVec& v) const;
+  virtual void retractationBatch_(RefMat out, const ConstRefMat& X,
+                                  const ConstRefMat& V) const;
+  virtual void pseudoLog_(RefVec out, const ConstRefVec& x,
+                          const ConstRefVec& y) const;
+  virtual void pseudoLogBatch_(RefMat out, const ConstRefMat& X,
+                               const ConstRefMat& Y) const;
+  virtual void pseudoLog0_(RefVec out, const ConstRefVec& x) const;
+  virtual void pseudoLog0Batch_(RefMat out, const ConstRefMat& X) const;
+  virtual void setZero_(RefVec out) const;
+  virtual void retractationWithJacobian_(RefVec out, RefMat J,
+                                         const ConstRefVec& x,
+                                         const ConstRefVec& v) const;
+  virtual void pseudoLogWithJacobian_(RefVec out, RefMat Jx, RefMat Jy,
+                                      const ConstRefVec& x,
+                                      const ConstRefVec& y) const;
+  virtual void applyDiffRetractation_(RefMat out, const ConstRefMat& in,
+                                      const ConstRefVec& x) const;
+  virtual void applyDiffPseudoLog0_(RefMat out, const ConstRefMat& in,
+                                    const ConstRefVec& x) const;
+  virtual void applyTransport_(RefMat out, const ConstRefMat& in,
+                               const ConstRefVec& x,
+                               const ConstRefVec& v) const;
+  virtual void applyInvTransport_(RefMat out, const ConstRefMat& in,
+                                  const ConstRefVec& x,
+                                  const ConstRefVec& v) const;
+  virtual void applyInvTransportOnTheRight_(RefMat out, const ConstRefMat& in,
+                                            const ConstRefVec& x,
+                                            const ConstRefVec& v) const;
+  virtual bool isInTxM_(const ConstRefVec& x, const ConstRefVec& v,
+                        const double& prec) const;
+  virtual void forceOnTxM_(RefVec out, const ConstRefVec& in,
+                           const ConstRefVec& x) const;
+
+  virtual std::shared_ptr<Manifold> getNewCopy_() const;
+
+  /// \brief The operations are dispatched statically, so that an enclosing
+  /// product calls them instead of going to the leaves
+  virtual bool isFlattenable() const;
+
+ private:
+  typedef std::tuple<Ms...> SubManifolds;
+
+  /// \brief Type, dimensions and start indices of the I-th submanifold
+  template <size_t I>
+  struct Sub
+  {
+    typedef typename std::tuple_element<I, SubManifolds>::type Type;
+    enum
+    {
+      T = StaticDimensions<Type>::TangentDim,
+      R = StaticDimensions<Type>::RepresentationDim,
+      startT = internal::StaticStart<I, Ms...>::T,
+      startR = internal::StaticStart<I, Ms...>::R
+    };
+  };
+
+  /// \brief Calls op.apply<I>(m_I) on each submanifold m_I
+  template <typename Op, size_t I = 0>
+  typename std::enable_if<(I < sizeof...(Ms))>::type forEach(Op& op) const
+  {
+    op.template apply<I>(std::get<I>(staticSubManifolds_));
+    forEach<Op, I + 1>(op);
+  }
+  template <typename Op, size_t I = 0>
+  typename std::enable_if<(I == sizeof...(Ms))>::type forEach(Op&) const
+  {
+  }
+
+  void registerSubManifolds();
+
+  struct Register;
+  struct ForceOnM;
+  struct Retractation;
+  struct RetractationBatch;
+  struct PseudoLog;
+  struct PseudoLogBatch;
+  struct PseudoLog0;
+  struct PseudoLog0Batch;
+  struct SetZero;
+  struct RetractationWithJacobian;
+  struct PseudoLogWithJacobian;
+  struct ApplyDiffRetractation;
+  struct ApplyDiffPseudoLog0;
+  struct ApplyTransport;
+  struct ApplyInvTransport;
+  struct ApplyInvTransportOnTheRight;
+  struct IsInTxM;
+  struct ForceOnTxM;
+
+  /// \brief The submanifolds, stored by value
+  SubManifolds staticSubManifolds_;
+
+  template <typename... Ns>
+  friend class StaticCartesianProduct;
+};
+
+// Operators applied on each submanifold. Since they are nested in a friend of
+// the submanifolds, they can call their protected implementation directly.
+template <typename... Ms>
+struct StaticCartesianProduct<Ms...>::Register
+{
+  CartesianProduct& self;
+  template <size_t I>
+  void apply(const typename Sub<I>::Type& m)
+  {
+    mnf_assert(m.tangentDim() == Sub<I>::T &&
+               m.representationDim() == Sub<I>::R &&
+               "StaticDimensions do not match the submanifold dimensions");
+    self.multiply(m);
+  }
+};
+
+template <typename... Ms>
+struct StaticCartesianProduct<Ms...>::ForceOnM
+{
+  RefVec& out;
+  const ConstRefVec& in;
+  template <size_t I>
+  void apply(const typename Sub<I>::Type& m)
+  {
+    typedef Sub<I> S;
+    typedef typename S::Type M;
+    m.M::forceOnM_(out.template segment<S::R>(S::startR),
+                   in.template segment<S::R>(S::startR));
+  }
+};
+
+template <typename... Ms>
+struct StaticCartesianProduct<Ms...>::Retractation
+{
+  RefVec& out;
+  const ConstRefVec& x;
+  const ConstRefVec& v;
+  template <size_t I>
+  void apply(const typename Sub<I>::Type& m)
+  {
+    typedef Sub<I> S;
+    typedef typename S::Type M;
+    m.M::retractation_(out.template segment<S::R>(S::startR),
+                       x.template segment<S::R>(S::startR),
+                       v.template segment<S::T>(S::startT));
+  }
+};
+
+template <typename... Ms>
+struct StaticCartesianProduct<Ms...>::RetractationBatch
+{
+  RefMat& out;
+  const ConstRefMat& X;
+  const ConstRefMat& V;
+  template <size_t I>
+  void apply(const typename Sub<I>::Type& m)
+  {
+    typedef Sub<I> S;
+    typedef typename S::Type M;
+    m.M::retractationBatch_(out.template middleRows<S::R>(S::startR),
+                            X.template middleRows<S::R>(S::startR),
+                            V.template middleRows<S::T>(S::startT));
+  }
+};
+
+template <typename... Ms>
+struct StaticCartesianProduct<Ms...>::PseudoLog
+{
+  RefVec& out;
+  const ConstRefVec& x;
+  const ConstRefVec& y;
+  template <size_t I>
+  void apply(const typename Sub<I>::Type& m)
+  {
+    typedef Sub<I> S;
+    typedef typename S::Type M;
+    m.M::pseudoLog_(out.template segment<S::T>(S::startT),
+                    x.template segment<S::R>(S::startR),
+                    y.template segment<S::R>(S::startR));
+  }
+};
+
+template <typename... Ms>
+struct StaticCartesianProduct<Ms...>::PseudoLogBatch
+{
+  RefMat& out;
+  const ConstRefMat& X;
+  const ConstRefMat& Y;
+  template <size_t I>
+  void apply(const typename Sub<I>::Type& m)
+  {
+    typedef Sub<I> S;
+    typedef typename S::Type M;
+    m.M::pseudoLogBatch_(out.template middleRows<S::T>(S::startT),
+                         X.template middleRows<S::R>(S::startR),
+                         Y.template middleRows<S::R>(S::startR));
+  }
+};
+
+template <typename... Ms>
+struct StaticCartesianProduct<Ms...>::PseudoLog0
+{
+  RefVec& out;
+  const ConstRefVec& x;
+  template <size_t I>
+  void apply(const typename Sub<I>::Type& m)
+  {
+    typedef Sub<I> S;
+    typedef typename S::Type M;
+    m.M::pseudoLog0_(out.template segment<S::T>(S::startT),
+                     x.template segment<S::R>(S::startR));
+  }
+};
+
+template <typename... Ms>
+struct StaticCartesianProduct<Ms...>::PseudoLog0Batch
+{
+  RefMat& out;
+  const ConstRefMat& X;
+  template <size_t I>
+  void apply(const typename Sub<I>::Type& m)
+  {
+    typedef Sub<I> S;
+    typedef typename S::Type M;
+    m.M::pseudoLog0Batch_(out.template middleRows<S::T>(S::startT),
+                          X.template middleRows<S::R>(S::startR));
+  }
+};
+
+template <typename... Ms>
+struct StaticCartesianProduct<Ms...>::SetZero
+{
+  RefVec& out;
+  template <size_t I>
+  void apply(const typename Sub<I>::Type& m)
+  {
+    typedef Sub<I> S;
+    typedef typename S::Type M;
+    m.M::setZero_(out.template segment<S::R>(S::startR));
+  }
+};
+
+template <typename... Ms>
+struct StaticCartesianProduct<Ms...>::RetractationWithJacobian
+{
+  RefVec& out;
+  RefMat& J;
+  const ConstRefVec& x;
+  const ConstRefVec& v;
+  template <size_t I>
+  void apply(const typename Sub<I>::Type& m)
+  {
+    typedef Sub<I> S;
+    typedef typename S::Type M;
+    m.M::retractationWithJacobian_(
+        out.template segment<S::R>(S::startR),
+        J.template block<S::R, S::T>(S::startR, S::startT),
+        x.template segment<S::R>(S::startR),
+        v.template segment<S::T>(S::startT));
+  }
+};
+
+template <typename... Ms>
+struct StaticCartesianProduct<Ms...>::PseudoLogWithJacobian
+{
+  RefVec& out;
+  RefMat& Jx;
+  RefMat& Jy;
+  const ConstRefVec& x;
+  const ConstRefVec& y;
+  template <size_t I>
+  void apply(const typename Sub<I>::Type& m)
+  {
+    typedef Sub<I> S;
+    typedef typename S::Type M;
+    m.M::pseudoLogWithJacobian_(
+        out.template segment<S::T>(S::startT),
+        Jx.template block<S::T, S::R>(S::startT, S::startR),
+        Jy.template block<S::T, S::R>(S::startT, S::startR),
+        x.template segment<S::R>(S::startR),
+        y.template segment<S::R>(S::startR));
+  }
+};
+
+template <typename... Ms>
+struct StaticCartesianProduct<Ms...>::ApplyDiffRetractation
+{
+  RefMat& out;
+  const ConstRefMat& in;
+  const ConstRefVec& x;
+  template <size_t I>
+  void apply(const typename Sub<I>::Type& m)
+  {
+    typedef Sub<I> S;
+    typedef typename S::Type M;
+    m.M::applyDiffRetractation_(out.template middleCols<S::T>(S::startT),
+                                in.template middleCols<S::R>(S::startR),
+                                x.template segment<S::R>(S::startR));
+  }
+};
+
+template <typename... Ms>
+struct StaticCartesianProduct<Ms...>::ApplyDiffPseudoLog0
+{
+  RefMat& out;
+  const ConstRefMat& in;
+  const ConstRefVec& x;
+  template <size_t I>
+  void apply(const typename Sub<I>::Type& m)
+  {
+    typedef Sub<I> S;
+    typedef typename S::Type M;
+    m.M::applyDiffPseudoLog0_(out.template middleCols<S::R>(S::startR),
+                              in.template middleCols<S::T>(S::startT),
+                              x.template segment<S::R>(S::startR));
+  }
+};
+
+template <typename... Ms>
+struct StaticCartesianProduct<Ms...>::ApplyTransport
+{
+  RefMat& out;
+  const ConstRefMat& in;
+  const ConstRefVec& x;
+  const ConstRefVec& v;
+  template <size_t I>
+  void apply(const typename Sub<I>::Type& m)
+  {
+    typedef Sub<I> S;
+    typedef typename S::Type M;
+    m.M::applyTransport_(out.template middleRows<S::T>(S::startT),
+                         in.template middleRows<S::T>(S::startT),
+                         x.template segment<S::R>(S::startR),
+                         v.template segment<S::T>(S::startT));
+  }
+};
+
+template <typename... Ms>
+struct StaticCartesianProduct<Ms...>::ApplyInvTransport
+{
+  RefMat& out;
+  const ConstRefMat& in;
+  const ConstRefVec& x;
+  const ConstRefVec& v;
+  template <size_t I>
+  void apply(const typename Sub<I>::Type& m)
+  {
+    typedef Sub<I> S;
+    typedef typename S::Type M;
+    m.M::applyInvTransport_(out.template middleRows<S::T>(S::startT),
+                            in.template middleRows<S::T>(S::startT),
+                            x.template segment<S::R>(S::startR),
+                            v.template segment<S::T>(S::startT));
+  }
+};
+
+template <typename... Ms>
+struct StaticCartesianProduct<Ms...>::ApplyInvTransportOnTheRight
+{
+  RefMat& out;
+  const ConstRefMat& in;
+  const ConstRefVec& x;
+  const ConstRefVec& v;
+  template <size_t I>
+  void apply(const typename Sub<I>::Type& m)
+  {
+    typedef Sub<I> S;
+    typedef typename S::Type M;
+    m.M::applyInvTransportOnTheRight_(out.template middleCols<S::T>(S::startT),
+                                      in.template middleCols<S::T>(S::startT),
+                                      x.template segment<S::R>(S::startR),
+                                      v.template segment<S::T>(S::startT));
+  }
+};
+
+template <typename... Ms>
+struct StaticCartesianProduct<Ms...>::IsInTxM
+{
+  const ConstRefVec& x;
+  const ConstRefVec& v;
+  const double& prec;
+  bool b;
+  template <size_t I>
+  void apply(const typename Sub<I>::Type& m)
+  {
+    typedef Sub<I> S;
+    typedef typename S::Type M;
+    b = b && m.M::isInTxM_(x.template segment<S::R>(S::startR),
+                           v.template segment<S::T>(S::startT), prec);
+  }
+};
+
+template <typename... Ms>
+struct StaticCartesianProduct<Ms...>::ForceOnTxM
+{
+  RefVec& out;
+  const ConstRefVec& in;
+  const ConstRefVec& x;
+  template <size_t I>
+  void apply(const typename Sub<I>::Type& m)
+  {
+    typedef Sub<I> S;
+    typedef typename S::Type M;
+    m.M::forceOnTxM_(out.template segment<S::T>(S::startT),
+                     in.template segment<S::T>(S::startT),
+                     x.template segment<S::R>(S::startR));
+  }
+};
+
+// Implementations of the methods
+template <typename... Ms>
+inline StaticCartesianProduct<Ms...>::StaticCartesianProduct()
+    : CartesianProduct()
+{
+  registerSubManifolds();
+  lock();
+}
+
+template <typename... Ms>
+inline StaticCartesianProduct<Ms...>::StaticCartesianProduct(const Ms&... m)
+    : CartesianProduct(), staticSubManifolds_(m...)
+{
+  registerSubManifolds();
+  lock();
+}
+
+template <typename... Ms>
+inline void StaticCartesianProduct<Ms...>::testMultiply() const
+{
+  // registerSubManifolds multiplies the product before it is locked
+  if (isLocked())
+    throw std::runtime_error(
+        "The submanifolds of a StaticCartesianProduct are fixed by its "
+        "template parameters, it cannot be multiplied.");
+}
+
+template <typename... Ms>
+inline void StaticCartesianProduct<Ms...>::registerSubManifolds()
+{
+  // The runtime description of the product is kept for the generic methods
+  // (views, display, topology...) inherited from CartesianProduct.
+  Register op = {*this};
+  forEach(op);
+}
+
+template <typename... Ms>
+inline void StaticCartesianProduct<Ms...>::forceOnM_(
+    RefVec out, const ConstRefVec& in) const
+{
+  ForceOnM op = {out, in};
+  forEach(op);
+}
+
+template <typename... Ms>
+inline void StaticCartesianProduct<Ms...>::retractation_(
+    RefVec out, const ConstRefVec& x, const ConstRefVec& v) const
+{
+  Retractation op = {out, x, v};
+  forEach(op);
+}
+
+template <typename... Ms>
+inline void StaticCartesianProduct<Ms...>::retractationBatch_(
+    RefMat out, const ConstRefMat& X, const ConstRefMat& V) const
+{
+  RetractationBatch op = {out, X, V};
+  forEach(op);
+}
+
+template <typename... Ms>
+inline void StaticCartesianProduct<Ms...>::pseudoLog_(
+    RefVec out, const ConstRefVec& x, const ConstRefVec& y) const
+{
+  PseudoLog op = {out, x, y};
+  forEach(op);
+}
+
+template <typename... Ms>
+inline void StaticCartesianProduct<Ms...>::pseudoLogBatch_(
+    RefMat out, const ConstRefMat& X, const ConstRefMat& Y) const
+{
+  PseudoLogBatch op = {out, X, Y};
+  forEach(op);
+}
+
+template <typename... Ms>
+inline void StaticCartesianProduct<Ms...>::pseudoLog0_(
+    RefVec out, const ConstRefVec& x) const
+{
+  PseudoLog0 op = {out, x};
+  forEach(op);
+}
+
+template <typename... Ms>
+inline void StaticCartesianProduct<Ms...>::pseudoLog0Batch_(
+    RefMat out, const ConstRefMat& X) const
+{
+  PseudoLog0Batch op = {out, X};
+  forEach(op);
+}
+
+template <typename... Ms>
+inline void StaticCartesianProduct<Ms...>::setZero_(RefVec out) const
+{
+  SetZero op = {out};
+  forEach(op);
+}
+
+template <typename... Ms>
+inline void StaticCartesianProduct<Ms...>::retractationWithJacobian_(
+    RefVec out, RefMat J, const ConstRefVec& x, const ConstRefVec& v) const
+{
+  J.setZero();
+  RetractationWithJacobian op = {out, J, x, v};
+  forEach(op);
+}
+
+template <typename... Ms>
+inline void StaticCartesianProduct<Ms...>::pseudoLogWithJacobian_(
+    RefVec out, RefMat Jx, RefMat Jy, const ConstRefVec& x,
+    const ConstRefVec& y) const
+{
+  Jx.setZero();
+  Jy.setZero();
+  PseudoLogWithJacobian op = {out, Jx, Jy, x, y};
+  forEach(op);
+}
+
+template <typename... Ms>
+inline void StaticCartesianProduct<Ms...>::applyDiffRetractation_(
+    RefMat out, const ConstRefMat& in, const ConstRefVec& x) const
+{
+  ApplyDiffRetractation op = {out, in, x};
+  forEach(op);
+}
+
+template <typename... Ms>
+inline void StaticCartesianProduct<Ms...>::applyDiffPseudoLog0_(
+    RefMat out, const ConstRefMat& in, const ConstRefVec& x) const
+{
+  ApplyDiffPseudoLog0 op = {out, in, x};
+  forEach(op);
+}
+
+template <typename... Ms>
+inline void StaticCartesianProduct<Ms...>::applyTransport_(
+    RefMat out, const ConstRefMat& in, const ConstRefVec& x,
+    const ConstRefVec& v) const
+{
+  ApplyTransport op = {out, in, x, v};
+  forEach(op);
+}
+
+template <typename... Ms>
+inline void StaticCartesianProduct<Ms...>::applyInvTransport_(
+    RefMat out, const ConstRefMat& in, const ConstRefVec& x,
+    const ConstRefVec& v) const
+{
+  ApplyInvTransport op = {out, in, x, v};
+  forEach(op);
+}
+
+template <typename... Ms>
+inline void StaticCartesianProduct<Ms...>::applyInvTransportOnTheRight_(
+    RefMat out, const ConstRefMat& in, const ConstRefVec& x,
+    const ConstRefVec& v) const
+{
+  ApplyInvTransportOnTheRight op = {out, in, x, v};
+  forEach(op);
+}
+
+template <typename... Ms>
+inline bool StaticCartesianProduct<Ms...>::isInTxM_(const ConstRefVec& x,
+                                                    const ConstRefVec& v,
+                                                    const double& prec) const
+{
+  IsInTxM op = {x, v, prec, true};
+  forEach(op);
+  return op.b;
+}
+
+template <typename... Ms>
+inline void StaticCartesianProduct<Ms...>::forceOnTxM_(
+    RefVec out, const ConstRefVec& in, const ConstRefVec& x) const
+{
+  ForceOnTxM op = {out, in, x};
+  forEach(op);
+}
+
+template <typename... Ms>
+std::shared_ptr<Manifold> StaticCartesianProduct<Ms...>::getNewCopy_() const
+{
+  std::shared_ptr<StaticCartesianProduct<Ms...> > copy(
+      new StaticCartesianProduct<Ms...>(*this));
+  return copy;
+}
+
+template <typename... Ms>
+inline bool StaticCartesianProduct<Ms...>::isFlattenable() const
+{
+  return false;
+}
+}
+
+#endif  //_MANIFOLDS_STATIC_CARTESIAN_PRODUCT_H_
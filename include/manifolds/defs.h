@@ -19,22 +19,38 @@
 #define _MANIFOLDS_DEFS_H_
 
 #include <memory>
+#include <vector>
 #include <Eigen/Core>
+#include <Eigen/SparseCore>
 
 #if defined(_MSC_FULL_VER)
 typedef unsigned int uint;
 #include <cstdint>
 #endif
 
+// The operator version of noexcept is available starting Visual Studio 2015
+// https://msdn.microsoft.com/en-us/library/dn956976.aspx
+#if defined(_MSC_FULL_VER) && _MSC_VER < 1900
+#define NOEXCEPT(x)
+#else
+#define NOEXCEPT(x) noexcept(x)
+#endif
+
 namespace mnf
 {
 typedef Eigen::Ref<Eigen::VectorXd> RefVec;
 typedef Eigen::Ref<const Eigen::VectorXd> ConstRefVec;
 typedef Eigen::Ref<Eigen::MatrixXd> RefMat;
 typedef Eigen::Ref<const Eigen::MatrixXd> ConstRefMat;
-typedef Eigen::Ref<Eigen::VectorXd>::SegmentReturnType Segment;
-typedef Eigen::Ref<const Eigen::VectorXd>::ConstSegmentReturnType ConstSegment;
+/// \internal Views are Ref objects rather than Block expressions: a Block
+/// keeps a reference on the (temporary) Ref it was taken from, and would
+/// dangle once the view is returned from getView.
+typedef RefVec Segment;
+typedef ConstRefVec ConstSegment;
 typedef Eigen::VectorXd::Index Index;
+typedef Eigen::SparseMatrix<double> SparseMat;
+typedef Eigen::SparseMatrix<double, Eigen::RowMajor> SparseRowMat;
+typedef Eigen::Triplet<double> Triplet;
 
 const Eigen::IOFormat defaultFormat(4, 0, ", ", "\n", "[", "]");
 }
@@ -15,14 +15,435 @@
 // manifolds. If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
 #include <manifolds/CartesianPower.h>
+#include <manifolds/mnf_assert.h>
 
 namespace mnf
 {
 CartesianPower::CartesianPower(const Manifold& M, const int n)
-    : CartesianProduct()
+    : CartesianProduct(),
+      base_(copyManifold(M)),
+      n_(static_cast<size_t>(n)),
+      r_(M.representationDim()),
+      t_(M.tangentDim())
+{
+  mnf_assert(n >= 0 && "invalid number of factors");
+  setDimension(n * M.dim());
+  setTangentDimension(n * t_);
+  setRepresentationDimension(n * r_);
+  for (int i = 0; i < n; ++i)
+  {
+    if (i > 0) name() += "x";
+    name() += M.name();
+  }
+  lock();
+}
+
+size_t CartesianPower::numberOfSubManifolds() const { return n_; }
+
+void CartesianPower::testMultiply() const
+{
+  throw std::runtime_error(
+      "A CartesianPower has a fixed number of factors, it cannot be "
+      "multiplied. Build a CartesianProduct containing it instead.");
+}
+
+template <typename Op>
+void CartesianPower::forEachRange(const Op& op) const
+{
+  const Index n = static_cast<Index>(n_);
+#ifdef _OPENMP
+  const Index grain = parallelGrain();
+  if (grain > 0 && representationDim() >= 2 * grain)
+  {
+    // Same cost estimate as the chunks of CartesianProduct: the size of the
+    // representation of the range
+    const Index c = std::max<Index>(1, grain / std::max<Index>(1, r_));
+    parallelFor(static_cast<int>((n + c - 1) / c), [&](int k)
+                {
+                  Index i0 = k * c;
+                  op(i0, std::min(c, n - i0));
+                });
+    return;
+  }
+#endif
+  op(0, n);
+}
+
+const Manifold& CartesianPower::operator()(const size_t i) const
+{
+  mnf_assert(i < n_ && "invalid index");
+  (void)i;
+  return *base_;
+}
+
+std::string CartesianPower::description(const std::string& prefix,
+                                        bool firstCall) const
+{
+  std::stringstream ss;
+  if (firstCall)
+  {
+    ss << prefix << "/cartprod--------------------------" << std::endl;
+    ss << this->description(prefix + "| ", false);
+    ss << prefix << "\\----------------------------------" << std::endl;
+  }
+  else
+  {
+    for (size_t i = 0; i < n_; ++i)
+    {
+      if (base_->isElementary())
+      {
+        ss << base_->description(prefix);
+      }
+      else
+      {
+        ss << prefix << "/cartprod--------------------------" << std::endl;
+        ss << base_->description(prefix + "| ", false);
+        ss << prefix << "\\----------------------------------" << std::endl;
+      }
+    }
+  }
+  return ss.str();
+}
+
+std::string CartesianPower::toString(const ConstRefVec& val,
+                                     const std::string& prefix,
+                                     const Eigen::IOFormat& fmt) const
+{
+  std::stringstream ss;
+  for (std::size_t i = 0; i < n_; ++i)
+  {
+    ss << base_->toString(val.segment(startR(i), r_), prefix + "  ", fmt);
+    if (i < n_ - 1) ss << std::endl;
+  }
+  return ss.str();
+}
+
+bool CartesianPower::isSameTopology(const Manifold& other) const
+{
+  if (dynamic_cast<const CartesianProduct*>(&other) &&
+      numberOfSubManifolds() == other.numberOfSubManifolds())
+  {
+    for (size_t i = 0; i < n_; ++i)
+    {
+      if (!base_->isSameTopology(other(i))) return false;
+    }
+    return true;
+  }
+  else
+    return false;
+}
+
+bool CartesianPower::isInM_(const Eigen::VectorXd& val, double prec) const
+{
+  bool out = true;
+  for (size_t i = 0; i < n_ && out; ++i)
+    out = base_->isInM(val.segment(startR(i), r_), prec);
+  return out;
+}
+
+void CartesianPower::forceOnM_(RefVec out, const ConstRefVec& in) const
+{
+  forEachRange([&](Index i0, Index n)
+               {
+                 for (Index i = i0; i < i0 + n; ++i)
+                   base_->forceOnM_(out.segment(i * r_, r_),
+                                    in.segment(i * r_, r_));
+               });
+}
+
+void CartesianPower::getIdentityOnTxM_(RefMat out, const ConstRefVec& x) const
+{
+  out.setZero();
+  for (size_t i = 0; i < n_; ++i)
+    base_->getIdentityOnTxM_(out.block(startT(i), startT(i), t_, t_),
+                             x.segment(startR(i), r_));
+}
+
+void CartesianPower::createRandomPoint_(RefVec out, const double coeff) const
+{
+  for (size_t i = 0; i < n_; ++i)
+    base_->createRandomPoint_(out.segment(startR(i), r_), coeff);
+}
+
+void CartesianPower::retractation_(RefVec out, const ConstRefVec& x,
+                                   const ConstRefVec& v) const
 {
-  for (int i = 0; i < n; ++i) this->multiply(M);
+  forEachRange([&](Index i0, Index n)
+               {
+                 base_->retractationBatch_(columnsR(out).middleCols(i0, n),
+                                           columnsR(x).middleCols(i0, n),
+                                           columnsT(v).middleCols(i0, n));
+               });
 }
+
+void CartesianPower::retractationBatch_(RefMat out, const ConstRefMat& X,
+                                        const ConstRefMat& V) const
+{
+  for (size_t i = 0; i < n_; ++i)
+  {
+    base_->retractationBatch_(out.middleRows(startR(i), r_),
+                              X.middleRows(startR(i), r_),
+                              V.middleRows(startT(i), t_));
+  }
 }
 
+void CartesianPower::pseudoLog_(RefVec out, const ConstRefVec& x,
+                                const ConstRefVec& y) const
+{
+  forEachRange([&](Index i0, Index n)
+               {
+                 base_->pseudoLogBatch_(columnsT(out).middleCols(i0, n),
+                                        columnsR(x).middleCols(i0, n),
+                                        columnsR(y).middleCols(i0, n));
+               });
+}
+
+void CartesianPower::pseudoLogBatch_(RefMat out, const ConstRefMat& X,
+                                     const ConstRefMat& Y) const
+{
+  for (size_t i = 0; i < n_; ++i)
+  {
+    base_->pseudoLogBatch_(out.middleRows(startT(i), t_),
+                           X.middleRows(startR(i), r_),
+                           Y.middleRows(startR(i), r_));
+  }
+}
+
+void CartesianPower::pseudoLog0_(RefVec out, const ConstRefVec& x) const
+{
+  forEachRange([&](Index i0, Index n)
+               {
+                 base_->pseudoLog0Batch_(columnsT(out).middleCols(i0, n),
+                                         columnsR(x).middleCols(i0, n));
+               });
+}
+
+void CartesianPower::pseudoLog0Batch_(RefMat out, const ConstRefMat& X) const
+{
+  for (size_t i = 0; i < n_; ++i)
+  {
+    base_->pseudoLog0Batch_(out.middleRows(startT(i), t_),
+                            X.middleRows(startR(i), r_));
+  }
+}
+
+void CartesianPower::setZero_(RefVec out) const
+{
+  forEachRange([&](Index i0, Index n)
+               {
+                 for (Index i = i0; i < i0 + n; ++i)
+                   base_->setZero_(out.segment(i * r_, r_));
+               });
+}
+
+Eigen::MatrixXd CartesianPower::diffRetractation_(const ConstRefVec& x) const
+{
+  Eigen::MatrixXd J(representationDim(), tangentDim());
+  J.setZero();
+  for (size_t i = 0; i < n_; ++i)
+  {
+    J.block(startR(i), startT(i), r_, t_) =
+        base_->diffRetractation_(x.segment(startR(i), r_));
+  }
+  return J;
+}
+
+void CartesianPower::retractationWithJacobian_(RefVec out, RefMat J,
+                                               const ConstRefVec& x,
+                                               const ConstRefVec& v) const
+{
+  J.setZero();
+  forEachRange([&](Index i0, Index n)
+               {
+                 for (Index i = i0; i < i0 + n; ++i)
+                   base_->retractationWithJacobian_(
+                       out.segment(i * r_, r_),
+                       J.block(i * r_, i * t_, r_, t_), x.segment(i * r_, r_),
+                       v.segment(i * t_, t_));
+               });
+}
+
+void CartesianPower::pseudoLogWithJacobian_(RefVec out, RefMat Jx, RefMat Jy,
+                                            const ConstRefVec& x,
+                                            const ConstRefVec& y) const
+{
+  Jx.setZero();
+  Jy.setZero();
+  forEachRange([&](Index i0, Index n)
+               {
+                 for (Index i = i0; i < i0 + n; ++i)
+                   base_->pseudoLogWithJacobian_(
+                       out.segment(i * t_, t_),
+                       Jx.block(i * t_, i * r_, t_, r_),
+                       Jy.block(i * t_, i * r_, t_, r_),
+                       x.segment(i * r_, r_), y.segment(i * r_, r_));
+               });
+}
+
+void CartesianPower::applyDiffRetractation_(RefMat out, const ConstRefMat& in,
+                                            const ConstRefVec& x) const
+{
+  forEachRange([&](Index i0, Index n)
+               {
+                 for (Index i = i0; i < i0 + n; ++i)
+                   base_->applyDiffRetractation_(out.middleCols(i * t_, t_),
+                                                 in.middleCols(i * r_, r_),
+                                                 x.segment(i * r_, r_));
+               });
+}
+
+Eigen::MatrixXd CartesianPower::diffPseudoLog0_(const ConstRefVec& x) const
+{
+  Eigen::MatrixXd J(tangentDim(), representationDim());
+  J.setZero();
+  for (size_t i = 0; i < n_; ++i)
+  {
+    J.block(startT(i), startR(i), t_, r_) =
+        base_->diffPseudoLog0_(x.segment(startR(i), r_));
+  }
+  return J;
+}
+
+void CartesianPower::applyDiffPseudoLog0_(RefMat out, const ConstRefMat& in,
+                                          const ConstRefVec& x) const
+{
+  forEachRange([&](Index i0, Index n)
+               {
+                 for (Index i = i0; i < i0 + n; ++i)
+                   base_->applyDiffPseudoLog0_(out.middleCols(i * r_, r_),
+                                               in.middleCols(i * t_, t_),
+                                               x.segment(i * r_, r_));
+               });
+}
+
+void CartesianPower::diffRetractationTriplets_(std::vector<Triplet>& out,
+                                               const ConstRefVec& x,
+                                               Index startR,
+                                               Index startT,
+                                               const UsedRows* used) const
+{
+  for (size_t i = 0; i < n_; ++i)
+  {
+    base_->diffRetractationTriplets_(out, x.segment(this->startR(i), r_),
+                                     startR + this->startR(i),
+                                     startT + this->startT(i), used);
+  }
+}
+
+void CartesianPower::diffPseudoLog0Triplets_(std::vector<Triplet>& out,
+                                             const ConstRefVec& x,
+                                             Index startT, Index startR,
+                                             const UsedRows* used) const
+{
+  for (size_t i = 0; i < n_; ++i)
+  {
+    base_->diffPseudoLog0Triplets_(out, x.segment(this->startR(i), r_),
+                                   startT + this->startT(i),
+                                   startR + this->startR(i), used);
+  }
+}
+
+void CartesianPower::applyTransport_(RefMat out, const ConstRefMat& in,
+                                     const ConstRefVec& x,
+                                     const ConstRefVec& v) const
+{
+  forEachRange([&](Index i0, Index n)
+               {
+                 for (Index i = i0; i < i0 + n; ++i)
+                   base_->applyTransport_(
+                       out.middleRows(i * t_, t_), in.middleRows(i * t_, t_),
+                       x.segment(i * r_, r_), v.segment(i * t_, t_));
+               });
+}
+
+void CartesianPower::applyInvTransport_(RefMat out, const ConstRefMat& in,
+                                        const ConstRefVec& x,
+                                        const ConstRefVec& v) const
+{
+  forEachRange([&](Index i0, Index n)
+               {
+                 for (Index i = i0; i < i0 + n; ++i)
+                   base_->applyInvTransport_(
+                       out.middleRows(i * t_, t_), in.middleRows(i * t_, t_),
+                       x.segment(i * r_, r_), v.segment(i * t_, t_));
+               });
+}
+
+void CartesianPower::applyInvTransportOnTheRight_(RefMat out,
+                                                  const ConstRefMat& in,
+                                                  const ConstRefVec& x,
+                                                  const ConstRefVec& v) const
+{
+  forEachRange([&](Index i0, Index n)
+               {
+                 for (Index i = i0; i < i0 + n; ++i)
+                   base_->applyInvTransportOnTheRight_(
+                       out.middleCols(i * t_, t_), in.middleCols(i * t_, t_),
+                       x.segment(i * r_, r_), v.segment(i * t_, t_));
+               });
+}
+
+void CartesianPower::tangentConstraint_(RefMat out, const ConstRefVec& x) const
+{
+  Index s = t_ - base_->dim();
+  out.setZero();
+  for (size_t i = 0; i < n_; ++i)
+  {
+    base_->tangentConstraint_(
+        out.block(static_cast<Index>(i) * s, startT(i), s, t_),
+        x.segment(startR(i), r_));
+  }
+}
+
+bool CartesianPower::isInTxM_(const ConstRefVec& x, const ConstRefVec& v,
+                              const double& prec) const
+{
+  bool b = true;
+  for (size_t i = 0; i < n_ && b; ++i)
+    b = base_->isInTxM_(x.segment(startR(i), r_), v.segment(startT(i), t_),
+                        prec);
+  return b;
+}
+
+void CartesianPower::forceOnTxM_(RefVec out, const ConstRefVec& in,
+                                 const ConstRefVec& x) const
+{
+  forEachRange([&](Index i0, Index n)
+               {
+                 for (Index i = i0; i < i0 + n; ++i)
+                   base_->forceOnTxM_(out.segment(i * t_, t_),
+                                      in.segment(i * t_, t_),
+                                      x.segment(i * r_, r_));
+               });
+}
+
+void CartesianPower::limitMap_(RefVec out) const
+{
+  for (size_t i = 0; i < n_; ++i) base_->limitMap_(out.segment(startT(i), t_));
+}
+
+void CartesianPower::getTypicalMagnitude_(RefVec out) const
+{
+  for (size_t i = 0; i < n_; ++i)
+    base_->getTypicalMagnitude_(out.segment(startT(i), t_));
+}
+
+void CartesianPower::getTrustMagnitude_(RefVec out) const
+{
+  for (size_t i = 0; i < n_; ++i)
+    base_->getTrustMagnitude_(out.segment(startT(i), t_));
+}
+
+std::shared_ptr<Manifold> CartesianPower::getNewCopy_() const
+{
+  std::shared_ptr<CartesianPower> copy(new CartesianPower(*this));
+  return copy;
+}
+
+bool CartesianPower::isFlattenable() const { return false; }
+}
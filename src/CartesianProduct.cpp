@@ -15,13 +15,34 @@
 // manifolds. If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+#include <exception>
+#include <typeinfo>
+
 #include <manifolds/defs.h>
 #include <manifolds/CartesianProduct.h>
+#include <manifolds/RealSpace.h>
 #include <manifolds/mnf_assert.h>
 
 namespace mnf
 {
-CartesianProduct::CartesianProduct() : Manifold(0, 0, 0)
+namespace
+{
+/// \brief The k consecutive blocks of size d starting at index start of v,
+/// seen as the columns of a matrix
+Eigen::Map<Eigen::MatrixXd> columns(RefVec v, Index start, Index d, Index k)
+{
+  return Eigen::Map<Eigen::MatrixXd>(v.data() + start, d, k);
+}
+
+Eigen::Map<const Eigen::MatrixXd> columns(const ConstRefVec& v, Index start,
+                                          Index d, Index k)
+{
+  return Eigen::Map<const Eigen::MatrixXd>(v.data() + start, d, k);
+}
+}
+
+CartesianProduct::CartesianProduct() : Manifold(0, 0, 0), parallelGrain_(0)
 {
   startIndexT_.push_back(0);
   startIndexR_.push_back(0);
@@ -29,7 +50,7 @@ CartesianProduct::CartesianProduct() : Manifold(0, 0, 0)
 }
 
 CartesianProduct::CartesianProduct(const std::initializer_list<Manifold*> m)
-    : Manifold(0, 0, 0)
+    : Manifold(0, 0, 0), parallelGrain_(0)
 {
   startIndexT_.push_back(0);
   startIndexR_.push_back(0);
@@ -38,7 +59,7 @@ CartesianProduct::CartesianProduct(const std::initializer_list<Manifold*> m)
 }
 
 CartesianProduct::CartesianProduct(const Manifold& m1, const Manifold& m2)
-    : Manifold(0, 0, 0)
+    : Manifold(0, 0, 0), parallelGrain_(0)
 {
   startIndexT_.push_back(0);
   startIndexR_.push_back(0);
@@ -59,8 +80,15 @@ bool CartesianProduct::isInM_(const Eigen::VectorXd& val, double) const
 
 void CartesianProduct::forceOnM_(RefVec out, const ConstRefVec& in) const
 {
-  for (std::size_t i = 0; i < numberOfSubManifolds(); ++i)
-    subManifolds_[i]->forceOnM(getView<R>(out, i), getConstView<R>(in, i));
+  forEachLeaf([&](const Leaf& l)
+              {
+                for (Index j = 0; j < l.count; ++j)
+                {
+                  Index r = l.startR + j * l.dimR;
+                  l.manifold->forceOnM_(out.segment(r, l.dimR),
+                                        in.segment(r, l.dimR));
+                }
+              });
 }
 
 void CartesianProduct::getIdentityOnTxM_(RefMat out, const ConstRefVec& x) const
@@ -77,9 +105,11 @@ void CartesianProduct::getIdentityOnTxM_(RefMat out, const ConstRefVec& x) const
   }
 }
 
+void CartesianProduct::testMultiply() const { testLock(); }
+
 CartesianProduct& CartesianProduct::multiply(const Manifold& m)
 {
-  testLock();
+  testMultiply();
   m.lock();
   if (dim() != 0) name() += "x";
   name() += m.name();
@@ -87,11 +117,129 @@ CartesianProduct& CartesianProduct::multiply(const Manifold& m)
   setTangentDimension(tangentDim() + m.tangentDim());
   setRepresentationDimension(representationDim() + m.representationDim());
   subManifolds_.push_back(std::shared_ptr<const Manifold>(copyManifold(m)));
+  appendLeaves(*subManifolds_.back(), startIndexR_.back(),
+               startIndexT_.back());
   startIndexT_.push_back(startIndexT_.back() + m.tangentDim());
   startIndexR_.push_back(startIndexR_.back() + m.representationDim());
+  if (parallelGrain_ > 0) buildChunks();
   return *this;
 }
 
+void CartesianProduct::setParallelGrain(Index grain)
+{
+  mnf_assert(grain >= 0 && "invalid grain");
+  parallelGrain_ = grain;
+  buildChunks();
+}
+
+Index CartesianProduct::parallelGrain() const { return parallelGrain_; }
+
+void CartesianProduct::buildChunks()
+{
+  chunks_.clear();
+#ifdef _OPENMP
+  if (parallelGrain_ == 0 || representationDim() < 2 * parallelGrain_) return;
+  for (const Leaf& l : leaves_)
+  {
+    // Cost estimate: the size of the representation of the chunk
+    Index n = std::max<Index>(1, parallelGrain_ / std::max<Index>(1, l.dimR));
+    for (Index j = 0; j < l.count; j += n)
+    {
+      chunks_.push_back({l.manifold, l.startR + j * l.dimR,
+                         l.startT + j * l.dimT, l.dimR, l.dimT,
+                         std::min(n, l.count - j)});
+    }
+  }
+#endif
+}
+
+void CartesianProduct::parallelFor(int n, const std::function<void(int)>& op)
+{
+#ifdef _OPENMP
+  // An exception must not leave the parallel region, it is rethrown after
+  std::exception_ptr error;
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < n; ++i)
+  {
+    try
+    {
+      op(i);
+    }
+    catch (...)
+    {
+#pragma omp critical(mnf_cartesian_product_error)
+      error = std::current_exception();
+    }
+  }
+  if (error) std::rethrow_exception(error);
+#else
+  for (int i = 0; i < n; ++i) op(i);
+#endif
+}
+
+template <typename Op>
+void CartesianProduct::forEachLeaf(const Op& op) const
+{
+#ifdef _OPENMP
+  if (!chunks_.empty())
+  {
+    parallelFor(static_cast<int>(chunks_.size()), [&](int i)
+                {
+                  op(chunks_[static_cast<size_t>(i)]);
+                });
+    return;
+  }
+#endif
+  for (const Leaf& l : leaves_) op(l);
+}
+
+void CartesianProduct::appendLeaves(const Manifold& m, Index startR,
+                                    Index startT)
+{
+  const CartesianProduct* p = dynamic_cast<const CartesianProduct*>(&m);
+  if (p && p->isFlattenable())
+  {
+    for (const Leaf& l : p->leaves_)
+      pushLeaf({l.manifold, startR + l.startR, startT + l.startT, l.dimR,
+                l.dimT, l.count});
+  }
+  else
+  {
+    pushLeaf({&m, startR, startT, m.representationDim(), m.tangentDim(), 1});
+  }
+}
+
+void CartesianProduct::pushLeaf(const Leaf& l)
+{
+  // Products are never merged: two products with the same type and
+  // dimensions can have different structures. The other leaves are only
+  // merged with leaves of the exact same class, as getTypeId is inherited by
+  // the derived classes that may override the operations.
+  if (!leaves_.empty() && !dynamic_cast<const CartesianProduct*>(l.manifold))
+  {
+    Leaf& last = leaves_.back();
+    if (typeid(*last.manifold) == typeid(*l.manifold))
+    {
+      if (typeid(*l.manifold) == typeid(RealSpace))
+      {
+        Index n = last.dimR * last.count + l.dimR * l.count;
+        mergedLeaves_.push_back(std::make_shared<RealSpace>(n));
+        last.manifold = mergedLeaves_.back().get();
+        last.dimR = n;
+        last.dimT = n;
+        last.count = 1;
+        return;
+      }
+      if (last.dimR == l.dimR && last.dimT == l.dimT)
+      {
+        last.count += l.count;
+        return;
+      }
+    }
+  }
+  leaves_.push_back(l);
+}
+
 size_t CartesianProduct::numberOfSubManifolds() const
 {
   return subManifolds_.size();
@@ -158,35 +306,103 @@ void CartesianProduct::createRandomPoint_(RefVec out, const double coeff) const
 void CartesianProduct::retractation_(RefVec out, const ConstRefVec& x,
                                      const ConstRefVec& v) const
 {
-  for (size_t i = 0; i < subManifolds_.size(); ++i)
+  forEachLeaf([&](const Leaf& l)
+              {
+                if (l.count == 1)
+                  l.manifold->retractation_(out.segment(l.startR, l.dimR),
+                                            x.segment(l.startR, l.dimR),
+                                            v.segment(l.startT, l.dimT));
+                else
+                  l.manifold->retractationBatch_(
+                      columns(out, l.startR, l.dimR, l.count),
+                      columns(x, l.startR, l.dimR, l.count),
+                      columns(v, l.startT, l.dimT, l.count));
+              });
+}
+
+void CartesianProduct::retractationBatch_(RefMat out, const ConstRefMat& X,
+                                          const ConstRefMat& V) const
+{
+  for (const Leaf& l : leaves_)
   {
-    subManifolds_[i]->retractation(getView<R>(out, i), getConstView<R>(x, i),
-                                   getConstView<T>(v, i));
+    for (Index j = 0; j < l.count; ++j)
+    {
+      Index r = l.startR + j * l.dimR;
+      l.manifold->retractationBatch_(out.middleRows(r, l.dimR),
+                                     X.middleRows(r, l.dimR),
+                                     V.middleRows(l.startT + j * l.dimT,
+                                                  l.dimT));
+    }
   }
 }
 
 void CartesianProduct::pseudoLog_(RefVec out, const ConstRefVec& x,
                                   const ConstRefVec& y) const
 {
-  for (size_t i = 0; i < subManifolds_.size(); ++i)
+  forEachLeaf([&](const Leaf& l)
+              {
+                if (l.count == 1)
+                  l.manifold->pseudoLog_(out.segment(l.startT, l.dimT),
+                                         x.segment(l.startR, l.dimR),
+                                         y.segment(l.startR, l.dimR));
+                else
+                  l.manifold->pseudoLogBatch_(
+                      columns(out, l.startT, l.dimT, l.count),
+                      columns(x, l.startR, l.dimR, l.count),
+                      columns(y, l.startR, l.dimR, l.count));
+              });
+}
+
+void CartesianProduct::pseudoLog0_(RefVec out, const ConstRefVec& x) const
+{
+  forEachLeaf([&](const Leaf& l)
+              {
+                if (l.count == 1)
+                  l.manifold->pseudoLog0_(out.segment(l.startT, l.dimT),
+                                          x.segment(l.startR, l.dimR));
+                else
+                  l.manifold->pseudoLog0Batch_(
+                      columns(out, l.startT, l.dimT, l.count),
+                      columns(x, l.startR, l.dimR, l.count));
+              });
+}
+
+void CartesianProduct::pseudoLogBatch_(RefMat out, const ConstRefMat& X,
+                                       const ConstRefMat& Y) const
+{
+  for (const Leaf& l : leaves_)
   {
-    subManifolds_[i]->pseudoLog(getView<T>(out, i), getConstView<R>(x, i),
-                                getConstView<R>(y, i));
+    for (Index j = 0; j < l.count; ++j)
+    {
+      Index r = l.startR + j * l.dimR;
+      l.manifold->pseudoLogBatch_(
+          out.middleRows(l.startT + j * l.dimT, l.dimT),
+          X.middleRows(r, l.dimR), Y.middleRows(r, l.dimR));
+    }
   }
 }
 
-void CartesianProduct::pseudoLog0_(RefVec out, const ConstRefVec& x) const
+void CartesianProduct::pseudoLog0Batch_(RefMat out, const ConstRefMat& X) const
 {
-  for (size_t i = 0; i < subManifolds_.size(); ++i)
+  for (const Leaf& l : leaves_)
   {
-    subManifolds_[i]->pseudoLog0(getView<T>(out, i), getConstView<R>(x, i));
+    for (Index j = 0; j < l.count; ++j)
+    {
+      l.manifold->pseudoLog0Batch_(
+          out.middleRows(l.startT + j * l.dimT, l.dimT),
+          X.middleRows(l.startR + j * l.dimR, l.dimR));
+    }
   }
 }
 
 void CartesianProduct::setZero_(RefVec out) const
 {
-  for (size_t i = 0; i < subManifolds_.size(); ++i)
-    subManifolds_[i]->setZero(getView<R>(out, i));
+  forEachLeaf([&](const Leaf& l)
+              {
+                for (Index j = 0; j < l.count; ++j)
+                  l.manifold->setZero_(
+                      out.segment(l.startR + j * l.dimR, l.dimR));
+              });
 }
 
 Eigen::MatrixXd CartesianProduct::diffRetractation_(const ConstRefVec& x) const
@@ -201,15 +417,57 @@ Eigen::MatrixXd CartesianProduct::diffRetractation_(const ConstRefVec& x) const
   return J;
 }
 
+void CartesianProduct::retractationWithJacobian_(RefVec out, RefMat J,
+                                                 const ConstRefVec& x,
+                                                 const ConstRefVec& v) const
+{
+  J.setZero();
+  forEachLeaf([&](const Leaf& l)
+              {
+                for (Index j = 0; j < l.count; ++j)
+                {
+                  Index r = l.startR + j * l.dimR;
+                  Index t = l.startT + j * l.dimT;
+                  l.manifold->retractationWithJacobian_(
+                      out.segment(r, l.dimR), J.block(r, t, l.dimR, l.dimT),
+                      x.segment(r, l.dimR), v.segment(t, l.dimT));
+                }
+              });
+}
+
+void CartesianProduct::pseudoLogWithJacobian_(RefVec out, RefMat Jx,
+                                              RefMat Jy, const ConstRefVec& x,
+                                              const ConstRefVec& y) const
+{
+  Jx.setZero();
+  Jy.setZero();
+  forEachLeaf([&](const Leaf& l)
+              {
+                for (Index j = 0; j < l.count; ++j)
+                {
+                  Index r = l.startR + j * l.dimR;
+                  Index t = l.startT + j * l.dimT;
+                  l.manifold->pseudoLogWithJacobian_(
+                      out.segment(t, l.dimT), Jx.block(t, r, l.dimT, l.dimR),
+                      Jy.block(t, r, l.dimT, l.dimR), x.segment(r, l.dimR),
+                      y.segment(r, l.dimR));
+                }
+              });
+}
+
 void CartesianProduct::applyDiffRetractation_(RefMat out, const ConstRefMat& in,
                                               const ConstRefVec& x) const
 {
-  for (size_t i = 0; i < subManifolds_.size(); ++i)
-  {
-    subManifolds_[i]->applyDiffRetractation(getView<F, T>(out, i),
-                                            getConstView<F, R>(in, i),
-                                            getConstView<R>(x, i));
-  }
+  forEachLeaf([&](const Leaf& l)
+              {
+                for (Index j = 0; j < l.count; ++j)
+                {
+                  Index r = l.startR + j * l.dimR;
+                  l.manifold->applyDiffRetractation_(
+                      out.middleCols(l.startT + j * l.dimT, l.dimT),
+                      in.middleCols(r, l.dimR), x.segment(r, l.dimR));
+                }
+              });
 }
 
 Eigen::MatrixXd CartesianProduct::diffPseudoLog0_(const ConstRefVec& x) const
@@ -227,11 +485,53 @@ Eigen::MatrixXd CartesianProduct::diffPseudoLog0_(const ConstRefVec& x) const
 void CartesianProduct::applyDiffPseudoLog0_(RefMat out, const ConstRefMat& in,
                                             const ConstRefVec& x) const
 {
-  for (size_t i = 0; i < subManifolds_.size(); ++i)
+  forEachLeaf([&](const Leaf& l)
+              {
+                for (Index j = 0; j < l.count; ++j)
+                {
+                  Index r = l.startR + j * l.dimR;
+                  l.manifold->applyDiffPseudoLog0_(
+                      out.middleCols(r, l.dimR),
+                      in.middleCols(l.startT + j * l.dimT, l.dimT),
+                      x.segment(r, l.dimR));
+                }
+              });
+}
+
+void CartesianProduct::diffRetractationTriplets_(std::vector<Triplet>& out,
+                                                 const ConstRefVec& x,
+                                                 Index startR,
+                                                 Index startT,
+                                                 const UsedRows* used) const
+{
+  for (const Leaf& l : leaves_)
   {
-    subManifolds_[i]->applyDiffPseudoLog0(getView<F, R>(out, i),
-                                          getConstView<F, T>(in, i),
-                                          getConstView<R>(x, i));
+    for (Index j = 0; j < l.count; ++j)
+    {
+      Index r = l.startR + j * l.dimR;
+      l.manifold->diffRetractationTriplets_(out, x.segment(r, l.dimR),
+                                            startR + r,
+                                            startT + l.startT + j * l.dimT,
+                                            used);
+    }
+  }
+}
+
+void CartesianProduct::diffPseudoLog0Triplets_(std::vector<Triplet>& out,
+                                               const ConstRefVec& x,
+                                               Index startT,
+                                               Index startR,
+                                               const UsedRows* used) const
+{
+  for (const Leaf& l : leaves_)
+  {
+    for (Index j = 0; j < l.count; ++j)
+    {
+      Index r = l.startR + j * l.dimR;
+      l.manifold->diffPseudoLog0Triplets_(out, x.segment(r, l.dimR),
+                                          startT + l.startT + j * l.dimT,
+                                          startR + r, used);
+    }
   }
 }
 
@@ -239,24 +539,34 @@ void CartesianProduct::applyTransport_(RefMat out, const ConstRefMat& in,
                                        const ConstRefVec& x,
                                        const ConstRefVec& v) const
 {
-  for (size_t i = 0; i < subManifolds_.size(); ++i)
-  {
-    subManifolds_[i]->applyTransport(
-        getView<T, F>(out, i), getConstView<T, F>(in, i), getConstView<R>(x, i),
-        getConstView<T>(v, i));
-  }
+  forEachLeaf([&](const Leaf& l)
+              {
+                for (Index j = 0; j < l.count; ++j)
+                {
+                  Index t = l.startT + j * l.dimT;
+                  l.manifold->applyTransport_(
+                      out.middleRows(t, l.dimT), in.middleRows(t, l.dimT),
+                      x.segment(l.startR + j * l.dimR, l.dimR),
+                      v.segment(t, l.dimT));
+                }
+              });
 }
 
 void CartesianProduct::applyInvTransport_(RefMat out, const ConstRefMat& in,
                                           const ConstRefVec& x,
                                           const ConstRefVec& v) const
 {
-  for (size_t i = 0; i < subManifolds_.size(); ++i)
-  {
-    subManifolds_[i]->applyInvTransport(
-        getView<F, T>(out, i), getConstView<F, T>(in, i), getConstView<R>(x, i),
-        getConstView<T>(v, i));
-  }
+  forEachLeaf([&](const Leaf& l)
+              {
+                for (Index j = 0; j < l.count; ++j)
+                {
+                  Index t = l.startT + j * l.dimT;
+                  l.manifold->applyInvTransport_(
+                      out.middleRows(t, l.dimT), in.middleRows(t, l.dimT),
+                      x.segment(l.startR + j * l.dimR, l.dimR),
+                      v.segment(t, l.dimT));
+                }
+              });
 }
 
 void CartesianProduct::applyInvTransportOnTheRight_(RefMat out,
@@ -264,12 +574,17 @@ void CartesianProduct::applyInvTransportOnTheRight_(RefMat out,
                                                     const ConstRefVec& x,
                                                     const ConstRefVec& v) const
 {
-  for (size_t i = 0; i < subManifolds_.size(); ++i)
-  {
-    subManifolds_[i]->applyInvTransportOnTheRight(
-        getView<F, T>(out, i), getConstView<F, T>(in, i), getConstView<R>(x, i),
-        getConstView<T>(v, i));
-  }
+  forEachLeaf([&](const Leaf& l)
+              {
+                for (Index j = 0; j < l.count; ++j)
+                {
+                  Index t = l.startT + j * l.dimT;
+                  l.manifold->applyInvTransportOnTheRight_(
+                      out.middleCols(t, l.dimT), in.middleCols(t, l.dimT),
+                      x.segment(l.startR + j * l.dimR, l.dimR),
+                      v.segment(t, l.dimT));
+                }
+              });
 }
 
 void CartesianProduct::tangentConstraint_(RefMat out,
@@ -291,18 +606,30 @@ bool CartesianProduct::isInTxM_(const ConstRefVec& x, const ConstRefVec& v,
                                 const double& prec) const
 {
   bool b = true;
-  for (size_t i = 0; i < subManifolds_.size() && b; ++i)
-    b = subManifolds_[i]->isInTxM(getConstView<R>(x, i), getConstView<T>(v, i),
-                                  prec);
+  for (size_t i = 0; i < leaves_.size() && b; ++i)
+  {
+    const Leaf& l = leaves_[i];
+    for (Index j = 0; j < l.count && b; ++j)
+      b = l.manifold->isInTxM_(x.segment(l.startR + j * l.dimR, l.dimR),
+                               v.segment(l.startT + j * l.dimT, l.dimT),
+                               prec);
+  }
   return b;
 }
 
 void CartesianProduct::forceOnTxM_(RefVec out, const ConstRefVec& in,
                                    const ConstRefVec& x) const
 {
-  for (size_t i = 0; i < subManifolds_.size(); ++i)
-    subManifolds_[i]->forceOnTxM(getView<T>(out, i), getConstView<T>(in, i),
-                                 getConstView<R>(x, i));
+  forEachLeaf([&](const Leaf& l)
+              {
+                for (Index j = 0; j < l.count; ++j)
+                {
+                  Index t = l.startT + j * l.dimT;
+                  l.manifold->forceOnTxM_(
+                      out.segment(t, l.dimT), in.segment(t, l.dimT),
+                      x.segment(l.startR + j * l.dimR, l.dimR));
+                }
+              });
 }
 
 void CartesianProduct::limitMap_(RefVec out) const
@@ -334,6 +661,8 @@ std::shared_ptr<Manifold> CartesianProduct::getNewCopy_() const
   return copy;
 }
 
+bool CartesianProduct::isFlattenable() const { return true; }
+
 bool CartesianProduct::isSameTopology(const Manifold& other) const
 {
   if (dynamic_cast<const CartesianProduct*>(&other) &&
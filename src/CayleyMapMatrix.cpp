@@ -0,0 +1,170 @@
+// Copyright (c) 2015 CNRS
+// Authors: Stanislas Brossette, Adrien Escande
+
+// This file is part of manifolds
+// manifolds is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+
+// manifolds is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// manifolds. If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <Eigen/Dense>
+#include <manifolds/defs.h>
+#include <manifolds/CayleyMapMatrix.h>
+#include <manifolds/mnf_assert.h>
+#include <manifolds/utils.h>
+
+namespace mnf
+{
+typedef Eigen::Map<const Eigen::Matrix3d> toConstMat3;
+typedef Eigen::Map<Eigen::Matrix3d> toMat3;
+
+#if defined(_MSC_FULL_VER) && _MSC_VER < 1900
+char CayleyMapMatrix::hashName[] = "CayleyMapMatrix";
+#endif
+
+void CayleyMapMatrix::retractation_(RefVec out, const ConstRefVec& x,
+                                    const ConstRefVec& v)
+{
+  OutputType E;
+  cayley(E, v);
+  toMat3(out.data()) = (toConstMat3(x.data())) * E;
+}
+
+void CayleyMapMatrix::retractationWithJacobian_(RefVec out, RefMat J,
+                                                const ConstRefVec& x,
+                                                const ConstRefVec& v)
+{
+  mnf_assert(v.size() == 3 && "Increment for the Cayley map must be of size 3");
+  // cay(v) = I + s*[v]x + s/2*[v]x^2 with s = 1/(1+|v|^2/4), and
+  // ds/dv = -s^2/2*v^T
+  double s = 1 / (1 + v.squaredNorm() / 4);
+  double ds = -s * s / 2;
+  Eigen::Matrix3d V, V2, K, dE;
+  utils::hat(V, v);
+  V2.noalias() = V * V;
+  const toConstMat3 X(x.data());
+  // d cay(v)/dv_k = s*[e_k]x + s/2*([e_k]x[v]x + [v]x[e_k]x)
+  //                 + ds*v_k*([v]x + [v]x^2/2)
+  for (int k = 0; k < 3; ++k)
+  {
+    utils::hat(K, Eigen::Vector3d::Unit(k));
+    dE = s * K + (ds * v(k)) * (V + V2 / 2);
+    dE.noalias() += (s / 2) * (K * V + V * K);
+    toMat3(J.col(k).data()).noalias() = X * dE;
+  }
+  OutputType E = Eigen::Matrix3d::Identity() + s * V + (s / 2) * V2;
+  toMat3(out.data()) = X * E;
+}
+
+void CayleyMapMatrix::pseudoLog_(RefVec out, const ConstRefVec& x,
+                                 const ConstRefVec& y)
+{
+  OutputType R(((toConstMat3(x.data())).transpose()) * (toConstMat3(y.data())));
+  invCayley(out, R);
+}
+
+void CayleyMapMatrix::pseudoLogWithJacobian_(RefVec out, RefMat Jx,
+                                             RefMat Jy, const ConstRefVec& x,
+                                             const ConstRefVec& y)
+{
+  OutputType R(((toConstMat3(x.data())).transpose()) * (toConstMat3(y.data())));
+  invCayley(out, R);
+  applyDiffTransposeProduct(
+      Jx, Jy,
+      diffPseudoLog0_(Eigen::Map<const Eigen::Matrix<double, 9, 1> >(R.data())),
+      x, y);
+}
+
+void CayleyMapMatrix::pseudoLog0_(RefVec out, const ConstRefVec& x)
+{
+  OutputType R(toConstMat3(x.data()));
+  invCayley(out, R);
+}
+
+void CayleyMapMatrix::retractationBatch_(RefMat out, const ConstRefMat& X,
+                                         const ConstRefMat& V)
+{
+  mnf_assert(X.rows() == 9 && V.rows() == 3 && out.rows() == 9);
+  for (Index j = 0; j < X.cols(); ++j)
+    retractation_(out.col(j), X.col(j), V.col(j));
+}
+
+void CayleyMapMatrix::pseudoLogBatch_(RefMat out, const ConstRefMat& X,
+                                      const ConstRefMat& Y)
+{
+  mnf_assert(X.rows() == 9 && Y.rows() == 9 && out.rows() == 3);
+  for (Index j = 0; j < X.cols(); ++j)
+    pseudoLog_(out.col(j), X.col(j), Y.col(j));
+}
+
+void CayleyMapMatrix::pseudoLog0Batch_(RefMat out, const ConstRefMat& X)
+{
+  mnf_assert(X.rows() == 9 && out.rows() == 3);
+  for (Index j = 0; j < X.cols(); ++j) pseudoLog0_(out.col(j), X.col(j));
+}
+
+void CayleyMapMatrix::cayley(OutputType& E, const ConstRefVec& v)
+{
+  mnf_assert(v.size() == 3 && "Increment for the Cayley map must be of size 3");
+  // cay(v) = I + s [v]x + c [v]x^2 with s = 1/(1+|v|^2/4) and c = s/2
+  double s = 1 / (1 + v.squaredNorm() / 4);
+  double c = s / 2;
+  E << 1 - c*(v.y() * v.y() + v.z() * v.z()), -s * v.z() + c * v.x() * v.y(),
+      s * v.y() + c * v.x() * v.z(), s * v.z() + c * v.x() * v.y(),
+      1 - c * (v.x() * v.x() + v.z() * v.z()), -s * v.x() + c * v.y() * v.z(),
+      -s * v.y() + c * v.x() * v.z(), s * v.x() + c * v.y() * v.z(),
+      1 - c * (v.x() * v.x() + v.y() * v.y());
+}
+
+void CayleyMapMatrix::invCayley(RefVec out, const OutputType& R)
+{
+  // cay^{-1}(R) = 2 d/(1+tr(R)) with d = (R21 - R12, R02 - R20, R10 - R01)
+  double t = 1 + R.trace();
+  mnf_assert(t > 0 &&
+             "The inverse of the Cayley map is not defined for angles of pi");
+  out << R(2, 1) - R(1, 2), R(0, 2) - R(2, 0), R(1, 0) - R(0, 1);
+  out *= 2 / t;
+}
+
+Eigen::Matrix<double, 3, 9> CayleyMapMatrix::diffPseudoLog0_(
+    const ConstRefVec& R)
+{
+  // R is stored column-wise: R(i,j) is R(i+3j)
+  double t = 1 + R(0) + R(4) + R(8);
+  double a = 2 / t;
+  Eigen::Vector3d v(a * (R(5) - R(7)), a * (R(6) - R(2)), a * (R(1) - R(3)));
+  Eigen::Matrix<double, 3, 9> J;
+  J.setZero();
+  // derivative of the trace
+  J.col(0) = -v / t;
+  J.col(4) = -v / t;
+  J.col(8) = -v / t;
+  // derivative of d
+  J(0, 5) = a;
+  J(0, 7) = -a;
+  J(1, 6) = a;
+  J(1, 2) = -a;
+  J(2, 1) = a;
+  J(2, 3) = -a;
+  return J;
+}
+
+void CayleyMapMatrix::applyDiffPseudoLog0_(RefMat out, const ConstRefMat& in,
+                                           const ConstRefVec& x,
+                                           ReusableTemporaryMap& m)
+{
+  mnf_assert(in.cols() == InputDim_ && "Dimensions mismatch");
+  Eigen::Map<Eigen::MatrixXd, Eigen::Aligned> a =
+      m.getMap(in.rows(), OutputDim_);
+  a.noalias() = in * diffPseudoLog0_(x);
+  out = a;
+}
+}
@@ -0,0 +1,160 @@
+// Copyright (c) 2015 CNRS
+// Authors: Stanislas Brossette, Adrien Escande
+
+// This file is part of manifolds
+// manifolds is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+
+// manifolds is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// manifolds. If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <Eigen/Dense>
+#include <manifolds/defs.h>
+#include <manifolds/CayleyMapQuaternion.h>
+#include <manifolds/mnf_assert.h>
+
+namespace mnf
+{
+typedef utils::QuaternionWxyzMap toQuat;
+typedef utils::ConstQuaternionWxyzMap toConstQuat;
+
+#if defined(_MSC_FULL_VER) && _MSC_VER < 1900
+char CayleyMapQuaternion::hashName[] = "CayleyMapQuaternion";
+#endif
+
+void CayleyMapQuaternion::retractation_(RefVec out, const ConstRefVec& x,
+                                        const ConstRefVec& v)
+{
+  OutputType q;
+  cayley(q, v);
+  toQuat(out.data())
+      .setProduct(toConstQuat(x.data()),
+                  toConstQuat(q.data()));  // out = x*cay(v)
+}
+
+void CayleyMapQuaternion::retractationWithJacobian_(RefVec out, RefMat J,
+                                                    const ConstRefVec& x,
+                                                    const ConstRefVec& v)
+{
+  mnf_assert(v.size() == 3 && "Increment for the Cayley map must be of size 3");
+  // cay(v) = s*(1, v/2) with s = 1/sqrt(1+|v|^2/4). Its derivative is
+  // (-s^3/4*v^T, s/2*I - s^3/8*v*v^T)
+  double s = 1 / sqrt(1 + v.squaredNorm() / 4);
+  double s3 = s * s * s;
+  Eigen::Matrix<double, 4, 3> dq;
+  dq.row(0) = (-s3 / 4) * v.transpose();
+  dq.bottomRows<3>() = (s / 2) * Eigen::Matrix3d::Identity();
+  dq.bottomRows<3>().noalias() -= (s3 / 8) * v * v.transpose();
+
+  // Matrix of the left multiplication by x, in the (w, x, y, z) convention
+  const toConstQuat xQ(x.data());
+  Eigen::Matrix4d L;
+  L << xQ.w(), -xQ.x(), -xQ.y(), -xQ.z(), xQ.x(), xQ.w(), -xQ.z(), xQ.y(),
+      xQ.y(), xQ.z(), xQ.w(), -xQ.x(), xQ.z(), -xQ.y(), xQ.x(), xQ.w();
+  J.noalias() = L * dq;
+
+  OutputType q;
+  toQuat(q.data()).w() = s;
+  toQuat(q.data()).vec() = (s / 2) * v;
+  toQuat(out.data()).setProduct(xQ, toConstQuat(q.data()));  // out = x*cay(v)
+}
+
+void CayleyMapQuaternion::pseudoLog_(RefVec out, const ConstRefVec& x,
+                                     const ConstRefVec& y)
+{
+  Eigen::Vector4d tmp;
+  toQuat(tmp.data())
+      .setInverseProduct(toConstQuat(x.data()),
+                         toConstQuat(y.data()));  // x^{-1}*y
+  invCayley(out, tmp);
+}
+
+void CayleyMapQuaternion::pseudoLogWithJacobian_(RefVec out, RefMat Jx,
+                                                 RefMat Jy,
+                                                 const ConstRefVec& x,
+                                                 const ConstRefVec& y)
+{
+  Eigen::Vector4d q;
+  toQuat(q.data())
+      .setInverseProduct(toConstQuat(x.data()),
+                         toConstQuat(y.data()));  // x^{-1}*y
+  invCayley(out, q);
+  applyDiffInverseProduct(Jx, Jy, diffPseudoLog0_(q), x, y);
+}
+
+void CayleyMapQuaternion::pseudoLog0_(RefVec out, const ConstRefVec& x)
+{
+  invCayley(out, x);
+}
+
+void CayleyMapQuaternion::retractationBatch_(RefMat out, const ConstRefMat& X,
+                                             const ConstRefMat& V)
+{
+  mnf_assert(X.rows() == 4 && V.rows() == 3 && out.rows() == 4);
+  for (Index j = 0; j < X.cols(); ++j)
+    retractation_(out.col(j), X.col(j), V.col(j));
+}
+
+void CayleyMapQuaternion::pseudoLogBatch_(RefMat out, const ConstRefMat& X,
+                                          const ConstRefMat& Y)
+{
+  mnf_assert(X.rows() == 4 && Y.rows() == 4 && out.rows() == 3);
+  for (Index j = 0; j < X.cols(); ++j)
+    pseudoLog_(out.col(j), X.col(j), Y.col(j));
+}
+
+void CayleyMapQuaternion::pseudoLog0Batch_(RefMat out, const ConstRefMat& X)
+{
+  mnf_assert(X.rows() == 4 && out.rows() == 3);
+  for (Index j = 0; j < X.cols(); ++j) invCayley(out.col(j), X.col(j));
+}
+
+void CayleyMapQuaternion::cayley(OutputType& q, const ConstRefVec& v)
+{
+  mnf_assert(v.size() == 3 && "Increment for the Cayley map must be of size 3");
+  // q = (1, v/2)/|(1, v/2)|
+  double s = 1 / sqrt(1 + v.squaredNorm() / 4);
+  toQuat(q.data()).w() = s;
+  toQuat(q.data()).vec() = (s / 2) * v;
+}
+
+void CayleyMapQuaternion::invCayley(RefVec out, const ConstRefVec& q)
+{
+  const toConstQuat qQ(q.data());
+  mnf_assert(qQ.w() != 0 &&
+             "The inverse of the Cayley map is not defined for angles of pi");
+  // q and -q give the same result
+  out = (2 / qQ.w()) * qQ.vec();
+}
+
+Eigen::Matrix<double, 3, 4> CayleyMapQuaternion::diffPseudoLog0_(
+    const ConstRefVec& x)
+{
+  const toConstQuat xQ(x.data());
+  Eigen::Matrix<double, 3, 4> J;
+  // This matrix is written in the (w, x, y, z) convention
+  // for quaternion notation.
+  J.col(0) = (-2 / (xQ.w() * xQ.w())) * xQ.vec();
+  J.rightCols<3>() = (2 / xQ.w()) * Eigen::Matrix3d::Identity();
+  return J;
+}
+
+void CayleyMapQuaternion::applyDiffPseudoLog0_(RefMat out,
+                                               const ConstRefMat& in,
+                                               const ConstRefVec& x,
+                                               ReusableTemporaryMap& m)
+{
+  mnf_assert(in.cols() == InputDim_ && "Dimensions mismatch");
+  Eigen::Map<Eigen::MatrixXd, Eigen::Aligned> a =
+      m.getMap(in.rows(), OutputDim_);
+  a.noalias() = in * diffPseudoLog0_(x);
+  out = a;
+}
+}
@@ -15,6 +15,7 @@
 // manifolds. If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
 #include <iostream>
 #include <boost/math/special_functions/sinc.hpp>
 #include <Eigen/Dense>
@@ -22,6 +23,9 @@
 #include <manifolds/defs.h>
 #include <manifolds/ExpMapMatrix.h>
 #include <manifolds/mnf_assert.h>
+#include <manifolds/utils.h>
+
+#include "Lanes.h"
 
 namespace utility
 {
@@ -59,6 +63,77 @@ typedef Eigen::Map<Eigen::Matrix3d> toMat3;
 char ExpMapMatrix::hashName[] = "ExpMapMatrix";
 #endif
 
+namespace
+{
+using namespace lanes;
+
+// In the following, the 3x3 matrices are stored column major in 9 lanes,
+// as in the representation of SO3: M(i, k) is M[i + 3 * k].
+
+/// \internal E = exp(v) (Rodrigues formula)
+inline void exponentialLanes(Lanes (&E)[9], const Lanes (&v)[3])
+{
+  Lanes n2 = v[0] * v[0] + v[1] * v[1] + v[2] * v[2];
+  mnf_assert((n2 < M_PI * M_PI).all() &&
+             "Increment for expMap must be of norm at most pi");
+  // With the half angle h = |v|/2, sin(|v|)/|v| = sinc(h) cos(h) and
+  // (1 - cos(|v|))/|v|^2 = sinc(h)^2 / 2, evaluated by series.
+  Lanes h2 = n2 / 4;
+  Lanes sinc = polynomial(sincCoeffs, h2);
+  Lanes s = sinc * polynomial(cosCoeffs, h2);
+  Lanes c = 0.5 * sinc * sinc;
+  Lanes xy = c * v[0] * v[1];
+  Lanes xz = c * v[0] * v[2];
+  Lanes yz = c * v[1] * v[2];
+  E[0] = 1 - c * (v[1] * v[1] + v[2] * v[2]);
+  E[1] = s * v[2] + xy;
+  E[2] = -s * v[1] + xz;
+  E[3] = -s * v[2] + xy;
+  E[4] = 1 - c * (v[0] * v[0] + v[2] * v[2]);
+  E[5] = s * v[0] + yz;
+  E[6] = s * v[1] + xz;
+  E[7] = -s * v[0] + yz;
+  E[8] = 1 - c * (v[0] * v[0] + v[1] * v[1]);
+}
+
+/// \internal v = log(R)
+inline void logarithmLanes(Lanes (&v)[3], const Lanes (&R)[9])
+{
+  // With d = (R21 - R12, R02 - R20, R10 - R01), sin(t) = |d|/2 and
+  // cos(t) = (tr(R) - 1)/2, and log(R) = t/(2 sin(t)) d, computed with
+  // t = atan2(sin(t), cos(t)), more accurate than acos for small angles.
+  Lanes d[3] = {R[5] - R[7], R[6] - R[2], R[1] - R[3]};
+  Lanes s = 0.5 * (d[0] * d[0] + d[1] * d[1] + d[2] * d[2]).sqrt();
+  Lanes c = 0.5 * (R[0] + R[4] + R[8] - 1);
+  Lanes a = atan2AbsOverY(s, c);
+  // for cos(t) < 0, t = pi - atan2(sin(t), |cos(t)|). At t = pi exactly,
+  // s = 0 and d = 0: the scalar logarithm returns 0, a finite f gives the same
+  Lanes f = 0.5 * (c < 0 && s > 0).select(M_PI / s - a, a);
+  for (int i = 0; i < 3; ++i) v[i] = f * d[i];
+}
+
+/// \internal C = A * B, or C = A^T * B if transposeA
+inline void product(Lanes (&C)[9], const Lanes (&A)[9], const Lanes (&B)[9],
+                    bool transposeA)
+{
+  for (int k = 0; k < 3; ++k)
+    for (int i = 0; i < 3; ++i)
+    {
+      // A(i, m) is A[i + 3 m], A^T(i, m) is A[m + 3 i]
+      const int si = transposeA ? 3 : 1;
+      const int sm = transposeA ? 1 : 3;
+      C[i + 3 * k] = A[i * si] * B[3 * k] + A[i * si + sm] * B[1 + 3 * k] +
+                     A[i * si + 2 * sm] * B[2 + 3 * k];
+    }
+}
+
+/// \internal Unused lanes of the rotation blocks hold the identity
+inline void setIdentityTail(Lanes (&R)[9], Index n)
+{
+  for (int i = 0; i < 9; i += 4) R[i].tail(BlockSize - n).setOnes();
+}
+}
+
 void ExpMapMatrix::retractation_(RefVec out, const ConstRefVec& x,
                                  const ConstRefVec& v)
 {
@@ -106,6 +181,72 @@ void ExpMapMatrix::pseudoLog0_(RefVec out, const ConstRefVec& x)
   logarithm(out, R);
 }
 
+void ExpMapMatrix::retractationBatch_(RefMat out, const ConstRefMat& X,
+                                      const ConstRefMat& V)
+{
+  mnf_assert(X.rows() == 9 && V.rows() == 3 && out.rows() == 9);
+  Lanes x[9], v[3], E[9], r[9];
+  for (Index j = 0; j < X.cols(); j += BlockSize)
+  {
+    Index n = std::min<Index>(BlockSize, X.cols() - j);
+    load(x, X, j, n, 0);
+    load(v, V, j, n, 0);
+    exponentialLanes(E, v);
+    product(r, x, E, false);  // out = x*exp(v)
+    store(out, r, j, n);
+  }
+}
+
+void ExpMapMatrix::pseudoLogBatch_(RefMat out, const ConstRefMat& X,
+                                   const ConstRefMat& Y)
+{
+  mnf_assert(X.rows() == 9 && Y.rows() == 9 && out.rows() == 3);
+  Lanes x[9], y[9], R[9], v[3];
+  for (Index j = 0; j < X.cols(); j += BlockSize)
+  {
+    Index n = std::min<Index>(BlockSize, X.cols() - j);
+    load(x, X, j, n, 0);
+    load(y, Y, j, n, 0);
+    setIdentityTail(x, n);
+    setIdentityTail(y, n);
+    product(R, x, y, true);  // x^T*y
+    logarithmLanes(v, R);
+    store(out, v, j, n);
+  }
+}
+
+void ExpMapMatrix::pseudoLog0Batch_(RefMat out, const ConstRefMat& X)
+{
+  logarithmBatch(out, X);
+}
+
+void ExpMapMatrix::exponentialBatch(RefMat out, const ConstRefMat& V)
+{
+  mnf_assert(V.rows() == 3 && out.rows() == 9 && out.cols() == V.cols());
+  Lanes v[3], E[9];
+  for (Index j = 0; j < V.cols(); j += BlockSize)
+  {
+    Index n = std::min<Index>(BlockSize, V.cols() - j);
+    load(v, V, j, n, 0);
+    exponentialLanes(E, v);
+    store(out, E, j, n);
+  }
+}
+
+void ExpMapMatrix::logarithmBatch(RefMat out, const ConstRefMat& R)
+{
+  mnf_assert(R.rows() == 9 && out.rows() == 3 && out.cols() == R.cols());
+  Lanes r[9], v[3];
+  for (Index j = 0; j < R.cols(); j += BlockSize)
+  {
+    Index n = std::min<Index>(BlockSize, R.cols() - j);
+    load(r, R, j, n, 0);
+    setIdentityTail(r, n);
+    logarithmLanes(v, r);
+    store(out, v, j, n);
+  }
+}
+
 void ExpMapMatrix::logarithm(RefVec out, const OutputType& R)
 {
   Eigen::Vector3d v(-R(1, 2), R(0, 2), -R(0, 1));
@@ -187,6 +328,79 @@ Eigen::Matrix<double, 9, 3> ExpMapMatrix::diffRetractation_(
   return J;
 }
 
+void ExpMapMatrix::retractationWithJacobian_(RefVec out, RefMat J,
+                                             const ConstRefVec& x,
+                                             const ConstRefVec& v)
+{
+  mnf_assert(v.size() == 3 && "Increment for expMap must be of size 3");
+  double n = v.squaredNorm();
+  mnf_assert(sqrt(n) < M_PI &&
+             "Increment for expMap must be of norm at most pi");
+  // exp(v) = I + s*[v]x + c*[v]x^2, with s = sin(t)/t, c = (1-cos(t))/t^2 and
+  // t = |v|. ds and dc are the derivatives of s and c with respect to t,
+  // divided by t.
+  double c, s, ds, dc;
+  if (n < prec)
+  {
+    c = 0.5 - n / 24;
+    s = 1 - n / 6;
+    ds = -1. / 3 + n / 30;
+    dc = -1. / 12 + n / 180;
+  }
+  else
+  {
+    double t = sqrt(n);
+    double cost = cos(t);
+    c = (1 - cost) / n;
+    s = sin(t) / t;
+    ds = (cost - s) / n;
+    dc = (s - 2 * c) / n;
+  }
+  Eigen::Matrix3d V, V2, K, dE;
+  utils::hat(V, v);
+  V2.noalias() = V * V;
+  const toConstMat3 X(x.data());
+  // d exp(v)/dv_k = s*[e_k]x + c*([e_k]x[v]x + [v]x[e_k]x)
+  //                 + v_k*(ds*[v]x + dc*[v]x^2)
+  for (int k = 0; k < 3; ++k)
+  {
+    utils::hat(K, Eigen::Vector3d::Unit(k));
+    dE = s * K + v(k) * (ds * V + dc * V2);
+    dE.noalias() += c * (K * V + V * K);
+    toMat3(J.col(k).data()).noalias() = X * dE;
+  }
+  OutputType E = Eigen::Matrix3d::Identity() + s * V + c * V2;
+  toMat3(out.data()) = X * E;
+}
+
+void ExpMapMatrix::pseudoLogWithJacobian_(RefVec out, RefMat Jx, RefMat Jy,
+                                          const ConstRefVec& x,
+                                          const ConstRefVec& y)
+{
+  OutputType R(((toConstMat3(x.data())).transpose()) * (toConstMat3(y.data())));
+  Eigen::Matrix<double, 3, 9> D;
+  logarithmWithJacobian(out, D, Eigen::Map<const Eigen::Matrix<double, 9, 1> >(
+                                    R.data()));
+  applyDiffTransposeProduct(Jx, Jy, D, x, y);
+}
+
+void ExpMapMatrix::applyDiffTransposeProduct(
+    RefMat Jx, RefMat Jy, const Eigen::Matrix<double, 3, 9>& D,
+    const ConstRefVec& x, const ConstRefVec& y)
+{
+  const toConstMat3 X(x.data());
+  const toConstMat3 Y(y.data());
+  // R = X^T*Y: the column l of R is X^T*Y(:,l), and the row l of R is
+  // X(:,l)^T*Y, so that dR(l,j)/dX(:,l) = Y(:,j)^T
+  Eigen::Matrix3d A;
+  for (int l = 0; l < 3; ++l)
+  {
+    Jy.middleCols<3>(3 * l).noalias() = D.middleCols<3>(3 * l) * X.transpose();
+    for (int j = 0; j < 3; ++j) A.col(j) = D.col(l + 3 * j);
+    Jx.middleCols<3>(3 * l).noalias() = A * Y.transpose();
+  }
+}
+
 void ExpMapMatrix::applyDiffRetractation_(RefMat out, const ConstRefMat& in,
                                           const ConstRefVec& x,
                                           ReusableTemporaryMap& m)
@@ -199,7 +413,16 @@ void ExpMapMatrix::applyDiffRetractation_(RefMat out, const ConstRefMat& in,
 
 Eigen::Matrix<double, 3, 9> ExpMapMatrix::diffPseudoLog0_(const ConstRefVec& R)
 {
+  Eigen::Vector3d out;
   Eigen::Matrix<double, 3, 9> J;
+  logarithmWithJacobian(out, J, R);
+  return J;
+}
+
+void ExpMapMatrix::logarithmWithJacobian(RefVec out,
+                                         Eigen::Matrix<double, 3, 9>& J,
+                                         const ConstRefVec& R)
+{
   J.setZero();
   // Valid approximation of the log when v<<1
   Eigen::Vector3d v((R(5) - R(7)) / 2, (R(6) - R(2)) / 2, (R(1) - R(3)) / 2);
@@ -220,7 +443,7 @@ Eigen::Matrix<double, 3, 9> ExpMapMatrix::diffPseudoLog0_(const ConstRefVec& R)
     // Here we use the Taylor approximation of the diff of the log
     double x = trR - 3;
     df = trR / 15 - (3 * (x * x)) / 140 + (2 * (x * x * x)) / 315 -
-         (5 * (x * x * x * x)) / 2772 - 11 / 30;
+         (5 * (x * x * x * x)) / 2772 - 11. / 30;
   }
   else
   {
@@ -235,7 +458,8 @@ Eigen::Matrix<double, 3, 9> ExpMapMatrix::diffPseudoLog0_(const ConstRefVec& R)
   J.col(6) = Eigen::Vector3d(0, hf, 0);
   J.col(7) = Eigen::Vector3d(-hf, 0, 0);
   J.col(8) = J.col(0);
-  return J;
+  // log(R) = acos((tr(R)-1)/2)/(2*sin(acos((tr(R)-1)/2))) * d = f * v
+  out = f * v;
 }
 
 void ExpMapMatrix::applyDiffPseudoLog0_(RefMat out, const ConstRefMat& in,
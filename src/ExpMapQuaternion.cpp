@@ -15,6 +15,7 @@
 // manifolds. If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
 #include <iostream>
 #include <boost/math/special_functions/sinc.hpp>
 #include <Eigen/Dense>
@@ -23,6 +24,8 @@
 #include <manifolds/ExpMapQuaternion.h>
 #include <manifolds/mnf_assert.h>
 
+#include "Lanes.h"
+
 namespace mnf
 {
 namespace utils
@@ -55,23 +58,70 @@ ConstReverseQuaternion::ConstReverseQuaternion(const double* data)
 }
 }
 
-typedef utils::ReverseQuaternion toQuat;
-typedef utils::ConstReverseQuaternion toConstQuat;
-// typedef Eigen::Map< Eigen::Quaterniond > toQuat;
-// typedef Eigen::Map< const Eigen::Quaterniond > toConstQuat;
+typedef utils::QuaternionWxyzMap toQuat;
+typedef utils::ConstQuaternionWxyzMap toConstQuat;
 const double ExpMapQuaternion::prec =
     1e-8;  // TODO Should be sqrt(sqrt(machine precision))
 #if defined(_MSC_FULL_VER) && _MSC_VER < 1900
 char ExpMapQuaternion::hashName[] = "ExpMapQuaternion";
 #endif
 
+namespace
+{
+using namespace lanes;
+
+/// \internal q = exp(v), q as (w, x, y, z)
+inline void exponentialLanes(Lanes (&q)[4], const Lanes (&v)[3])
+{
+  Lanes n2 = v[0] * v[0] + v[1] * v[1] + v[2] * v[2];
+  mnf_assert((n2 < M_PI * M_PI).all() &&
+             "Increment for expMap must be of norm at most pi");
+  Lanes h2 = n2 / 4;
+  Lanes s = 0.5 * polynomial(sincCoeffs, h2);  // sin(|v|/2)/|v|
+  q[0] = polynomial(cosCoeffs, h2);
+  for (int i = 0; i < 3; ++i) q[i + 1] = s * v[i];
+}
+
+/// \internal v = log(q), q as (w, x, y, z)
+inline void logarithmLanes(Lanes (&v)[3], const Lanes (&q)[4])
+{
+  // log(q) = atan2(2 n w, w^2 - n^2) / n * q.vec() = 2 atan2(n, |w|) / n *
+  // sign(w) q.vec(), with n = |q.vec()|
+  Lanes n = (q[1] * q[1] + q[2] * q[2] + q[3] * q[3]).sqrt();
+  Lanes sign = (q[0] < 0).select(Lanes::Constant(-2), Lanes::Constant(2));
+  Lanes f = sign * atan2AbsOverY(n, q[0]);
+  for (int i = 0; i < 3; ++i) v[i] = f * q[i + 1];
+}
+
+/// \internal c = a * b
+inline void product(Lanes (&c)[4], const Lanes (&a)[4], const Lanes (&b)[4])
+{
+  c[0] = a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3];
+  c[1] = a[0] * b[1] + b[0] * a[1] + a[2] * b[3] - a[3] * b[2];
+  c[2] = a[0] * b[2] + b[0] * a[2] + a[3] * b[1] - a[1] * b[3];
+  c[3] = a[0] * b[3] + b[0] * a[3] + a[1] * b[2] - a[2] * b[1];
+}
+
+/// \internal c = a^{-1} * b
+inline void inverseProduct(Lanes (&c)[4], const Lanes (&a)[4],
+                           const Lanes (&b)[4])
+{
+  Lanes n2 = a[0] * a[0] + a[1] * a[1] + a[2] * a[2] + a[3] * a[3];
+  c[0] = (a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3]) / n2;
+  c[1] = (a[0] * b[1] - b[0] * a[1] - a[2] * b[3] + a[3] * b[2]) / n2;
+  c[2] = (a[0] * b[2] - b[0] * a[2] - a[3] * b[1] + a[1] * b[3]) / n2;
+  c[3] = (a[0] * b[3] - b[0] * a[3] - a[1] * b[2] + a[2] * b[1]) / n2;
+}
+}
+
 void ExpMapQuaternion::retractation_(RefVec out, const ConstRefVec& x,
                                      const ConstRefVec& v)
 {
   OutputType q;
   exponential(q, v);
-  toQuat(out.data()) =
-      (toConstQuat(x.data())) * (toConstQuat(q.data()));  // out = x*exp(v)
+  toQuat(out.data())
+      .setProduct(toConstQuat(x.data()),
+                  toConstQuat(q.data()));  // out = x*exp(v)
 }
 
 void ExpMapQuaternion::exponential(OutputType& q, const ConstRefVec& v)
@@ -100,11 +150,9 @@ void ExpMapQuaternion::pseudoLog_(RefVec out, const ConstRefVec& x,
                                   const ConstRefVec& y)
 {
   Eigen::Vector4d tmp;
-  toQuat q(tmp.data());
   const toConstQuat xQ(x.data());
   const toConstQuat yQ(y.data());
-  q = xQ.inverse() * yQ;  // TODO double-check that formula
-  q.writeChanges();
+  toQuat(tmp.data()).setInverseProduct(xQ, yQ);  // x^{-1}*y
   logarithm(out, tmp);
 }
 
@@ -113,6 +161,71 @@ void ExpMapQuaternion::pseudoLog0_(RefVec out, const ConstRefVec& x)
   logarithm(out, x);
 }
 
+void ExpMapQuaternion::retractationBatch_(RefMat out, const ConstRefMat& X,
+                                          const ConstRefMat& V)
+{
+  mnf_assert(X.rows() == 4 && V.rows() == 3 && out.rows() == 4);
+  Lanes x[4], v[3], q[4], r[4];
+  for (Index j = 0; j < X.cols(); j += BlockSize)
+  {
+    Index n = std::min<Index>(BlockSize, X.cols() - j);
+    load(x, X, j, n, 1);
+    load(v, V, j, n, 0);
+    exponentialLanes(q, v);
+    product(r, x, q);  // out = x*exp(v)
+    store(out, r, j, n);
+  }
+}
+
+void ExpMapQuaternion::pseudoLogBatch_(RefMat out, const ConstRefMat& X,
+                                       const ConstRefMat& Y)
+{
+  mnf_assert(X.rows() == 4 && Y.rows() == 4 && out.rows() == 3);
+  Lanes x[4], y[4], q[4], v[3];
+  for (Index j = 0; j < X.cols(); j += BlockSize)
+  {
+    Index n = std::min<Index>(BlockSize, X.cols() - j);
+    load(x, X, j, n, 1);
+    load(y, Y, j, n, 1);
+    inverseProduct(q, x, y);  // x^{-1}*y
+    logarithmLanes(v, q);
+    store(out, v, j, n);
+  }
+}
+
+void ExpMapQuaternion::pseudoLog0Batch_(RefMat out, const ConstRefMat& X)
+{
+  logarithmBatch(out, X);
+}
+
+void ExpMapQuaternion::exponentialBatch(RefMat out, const ConstRefMat& V)
+{
+  mnf_assert(V.rows() == 3 && out.rows() == 4 && out.cols() == V.cols());
+  Lanes v[3], q[4];
+  for (Index j = 0; j < V.cols(); j += BlockSize)
+  {
+    Index n = std::min<Index>(BlockSize, V.cols() - j);
+    load(v, V, j, n, 0);
+    exponentialLanes(q, v);
+    store(out, q, j, n);
+  }
+}
+
+void ExpMapQuaternion::logarithmBatch(RefMat out, const ConstRefMat& Q)
+{
+  mnf_assert(Q.rows() == 4 && out.rows() == 3 && out.cols() == Q.cols());
+  Lanes q[4], v[3];
+  for (Index j = 0; j < Q.cols(); j += BlockSize)
+  {
+    Index n = std::min<Index>(BlockSize, Q.cols() - j);
+    // unused lanes hold the identity, whose logarithm is well defined
+    load(q, Q, j, n, 0);
+    q[0].tail(BlockSize - n).setOnes();
+    logarithmLanes(v, q);
+    store(out, v, j, n);
+  }
+}
+
 void ExpMapQuaternion::logarithm(RefVec out, const OutputType& v)
 {
   const toConstQuat vQ(v.data());
@@ -140,11 +253,8 @@ bool ExpMapQuaternion::isInM_(const Eigen::VectorXd& val, double prec)
 
 void ExpMapQuaternion::forceOnM_(RefVec out, const ConstRefVec& in)
 {
-  toConstQuat inQuat(in.data());
-  toQuat outQuat(out.data());
-  outQuat = inQuat;
-  outQuat.normalize();
-  outQuat.writeChanges();
+  out = in;
+  toQuat(out.data()).normalize();
 }
 
 void ExpMapQuaternion::getIdentityOnTxM_(RefMat out, const ConstRefVec&)
@@ -165,6 +275,84 @@ Eigen::Matrix<double, 4, 3> ExpMapQuaternion::diffRetractation_(
   return J;
 }
 
+void ExpMapQuaternion::retractationWithJacobian_(RefVec out, RefMat J,
+                                                 const ConstRefVec& x,
+                                                 const ConstRefVec& v)
+{
+  mnf_assert(v.size() == 3 && "Increment for expMap must be of size 3");
+  double n2 = v.squaredNorm();
+  mnf_assert(sqrt(n2) < M_PI &&
+             "Increment for expMap must be of norm at most pi");
+  // exp(v) = (c, s*v) with c = cos(t/2), s = sin(t/2)/t and t = |v|. Its
+  // derivative is (-s/2*v^T, s*I + g*v*v^T) with g = (ds/dt)/t
+  double c, s, g;
+  if (n2 < prec)
+  {
+    c = 1 + (-1 + n2 / 48) * (n2 / 8);
+    s = (1 + (-1 + 0.0125 * n2) * n2 / 24) / 2;
+    g = -1. / 24 + n2 / 960;
+  }
+  else
+  {
+    double t = sqrt(n2);
+    c = cos(0.5 * t);
+    s = sin(0.5 * t) / t;
+    g = (c / 2 - s) / n2;
+  }
+  Eigen::Matrix<double, 4, 3> dq;
+  dq.row(0) = (-s / 2) * v.transpose();
+  dq.bottomRows<3>() = s * Eigen::Matrix3d::Identity();
+  dq.bottomRows<3>().noalias() += g * v * v.transpose();
+
+  // Matrix of the left multiplication by x, in the (w, x, y, z) convention
+  const toConstQuat xQ(x.data());
+  Eigen::Matrix4d L;
+  L << xQ.w(), -xQ.x(), -xQ.y(), -xQ.z(), xQ.x(), xQ.w(), -xQ.z(), xQ.y(),
+      xQ.y(), xQ.z(), xQ.w(), -xQ.x(), xQ.z(), -xQ.y(), xQ.x(), xQ.w();
+  J.noalias() = L * dq;
+
+  OutputType q;
+  toQuat(q.data()).w() = c;
+  toQuat(q.data()).vec() = s * v;
+  toQuat(out.data()).setProduct(xQ, toConstQuat(q.data()));  // out = x*exp(v)
+}
+
+void ExpMapQuaternion::pseudoLogWithJacobian_(RefVec out, RefMat Jx,
+                                              RefMat Jy, const ConstRefVec& x,
+                                              const ConstRefVec& y)
+{
+  Eigen::Vector4d q;
+  toQuat(q.data())
+      .setInverseProduct(toConstQuat(x.data()),
+                         toConstQuat(y.data()));  // x^{-1}*y
+  Eigen::Matrix<double, 3, 4> D;
+  logarithmWithJacobian(out, D, q);
+  applyDiffInverseProduct(Jx, Jy, D, x, y);
+}
+
+void ExpMapQuaternion::applyDiffInverseProduct(
+    RefMat Jx, RefMat Jy, const Eigen::Matrix<double, 3, 4>& D,
+    const ConstRefVec& x, const ConstRefVec& y)
+{
+  const toConstQuat xQ(x.data());
+  const toConstQuat yQ(y.data());
+  double n2 = xQ.squaredNorm();
+  Eigen::Vector4d q;
+  toQuat(q.data()).setInverseProduct(xQ, yQ);
+  // q = conj(x)*y/|x|^2, so that dq/dy = L/|x|^2 and
+  // dq/dx = (R - 2*q*x^T)/|x|^2, with L the matrix of the left multiplication
+  // by conj(x), and R the one of the right multiplication by y composed with
+  // the conjugation. They are written in the (w, x, y, z) convention.
+  Eigen::Matrix4d L, R;
+  L << xQ.w(), xQ.x(), xQ.y(), xQ.z(), -xQ.x(), xQ.w(), xQ.z(), -xQ.y(),
+      -xQ.y(), -xQ.z(), xQ.w(), xQ.x(), -xQ.z(), xQ.y(), -xQ.x(), xQ.w();
+  R << yQ.w(), yQ.x(), yQ.y(), yQ.z(), yQ.x(), -yQ.w(), -yQ.z(), yQ.y(),
+      yQ.y(), yQ.z(), -yQ.w(), -yQ.x(), yQ.z(), -yQ.y(), yQ.x(), -yQ.w();
+  Jy.noalias() = (D * L) / n2;
+  Jx.noalias() = (D * R) / n2;
+  Jx.noalias() -= ((2 / n2) * (D * q)) * xQ.wxyz().transpose();
+}
+
 void ExpMapQuaternion::applyDiffRetractation_(RefMat out, const ConstRefMat& in,
                                               const ConstRefVec& x,
                                               ReusableTemporaryMap& m)
@@ -177,16 +365,26 @@ void ExpMapQuaternion::applyDiffRetractation_(RefMat out, const ConstRefMat& in,
 
 Eigen::Matrix<double, 3, 4> ExpMapQuaternion::diffPseudoLog0_(
     const ConstRefVec& v)
+{
+  Eigen::Vector3d out;
+  Eigen::Matrix<double, 3, 4> J;
+  logarithmWithJacobian(out, J, v);
+  return J;
+}
+
+void ExpMapQuaternion::logarithmWithJacobian(RefVec out,
+                                             Eigen::Matrix<double, 3, 4>& J,
+                                             const ConstRefVec& v)
 {
   const toConstQuat vQ(v.data());
   double n2 = vQ.vec().squaredNorm();
   double n = sqrt(n2);
-  Eigen::Matrix<double, 3, 4> J;
 
   if (n < prec && vQ.w() != 0)
   {
     double a = 2 / vQ.w();
     double b = -2 / (vQ.w() * vQ.w());
+    out = a * vQ.vec();
     // This matrix is written in the (w, x, y, z) convention
     // for quaternion notation.
     J << b* vQ.x(), a, 0, 0, b * vQ.y(), 0, a, 0, b * vQ.z(), 0, 0, a;
@@ -238,11 +436,11 @@ Eigen::Matrix<double, 3, 4> ExpMapQuaternion::diffPseudoLog0_(
     // 	   dfdw*vQ.y(), g*vQ.x()*vQ.y(), g*vQ.y()*vQ.y()+f, g*vQ.z()*vQ.y(),
     // 	   dfdw*vQ.z(), g*vQ.x()*vQ.z(), g*vQ.y()*vQ.z(), g*vQ.z()*vQ.z()+f;
 
+    out = f * vQ.vec();
     J.col(0) = dfdw * vQ.vec();
     J.rightCols<3>() = f * Eigen::Matrix3d::Identity();
     J.rightCols<3>().noalias() += g * vQ.vec() * vQ.vec().transpose();
   }
-  return J;
 }
 
 void ExpMapQuaternion::applyDiffPseudoLog0_(RefMat out, const ConstRefMat& in,
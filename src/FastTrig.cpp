@@ -0,0 +1,188 @@
+// Copyright (c) 2015 CNRS
+// Authors: Stanislas Brossette, Adrien Escande
+
+// This file is part of manifolds
+// manifolds is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+
+// manifolds is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// manifolds. If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <cmath>
+#include <Eigen/Dense>
+#include <manifolds/defs.h>
+#include <manifolds/FastTrig.h>
+#include <manifolds/mnf_assert.h>
+
+#include "Lanes.h"
+
+namespace mnf
+{
+const double FastTrig<ExpMapMatrix>::errorBound = 1e-9;
+const double FastTrig<ExpMapQuaternion>::errorBound = 1e-9;
+#if defined(_MSC_FULL_VER) && _MSC_VER < 1900
+char FastTrig<ExpMapMatrix>::hashName[] = "FastTrigExpMapMatrix";
+char FastTrig<ExpMapQuaternion>::hashName[] = "FastTrigExpMapQuaternion";
+#endif
+
+typedef Eigen::Map<const Eigen::Matrix3d> toConstMat3;
+typedef Eigen::Map<Eigen::Matrix3d> toMat3;
+typedef utils::QuaternionWxyzMap toQuat;
+typedef utils::ConstQuaternionWxyzMap toConstQuat;
+
+namespace
+{
+/// \internal Evaluates the polynomial sum_{i<N} c[i] z^i
+template <int N, int M>
+inline double series(const double(&c)[M], double z)
+{
+  static_assert(N <= M, "Not enough coefficients");
+  double r = c[N - 1];
+  for (int i = N - 2; i >= 0; --i) r = r * z + c[i];
+  return r;
+}
+
+/// \internal Number of terms of the series of the exponential. For the half
+/// angle |h| <= pi/2, the first neglected terms are h^16/16! < 7e-11 for the
+/// cosine and h^16/17! < 4e-12 for the sinc, that are multiplied by at most
+/// |v| < pi in the results.
+const int ExpTerms = 8;
+
+/// \internal cos(h) and sin(h)/h for h^2 = h2
+inline void halfAngle(double h2, double& cosH, double& sincH)
+{
+  cosH = series<ExpTerms>(lanes::cosCoeffs, h2);
+  sincH = series<ExpTerms>(lanes::sincCoeffs, h2);
+}
+
+/// \internal atan(r)/r for 0 <= r <= 1, see lanes::atanOverX
+inline double atanOverX(double r)
+{
+  if (r > 0.66)
+  {
+    double x = (r - 1) / (r + 1);
+    double z = x * x;
+    double p = z * series<5>(lanes::atanP, z) / series<6>(lanes::atanQ, z);
+    return ((M_PI / 4 + 0.5 * 6.123233995736765886130E-17) + x + x * p) / r;
+  }
+  double z = r * r;
+  return 1 + z * series<5>(lanes::atanP, z) / series<6>(lanes::atanQ, z);
+}
+
+/// \internal atan2(y, |x|)/y for y >= 0, see lanes::atan2AbsOverY
+inline double atan2AbsOverY(double y, double x)
+{
+  double ax = std::abs(x);
+  if (y <= ax) return atanOverX(y / ax) / ax;
+  double r = ax / y;
+  return (M_PI / 2 - r * atanOverX(r)) / y;
+}
+}
+
+void FastTrig<ExpMapMatrix>::retractation_(RefVec out, const ConstRefVec& x,
+                                           const ConstRefVec& v)
+{
+  OutputType E;
+  exponential(E, v);
+  toMat3(out.data()) = (toConstMat3(x.data())) * E;
+}
+
+void FastTrig<ExpMapMatrix>::exponential(OutputType& E, const ConstRefVec& v)
+{
+  mnf_assert(v.size() == 3 && "Increment for expMap must be of size 3");
+  double n = v.squaredNorm();
+  mnf_assert(n < M_PI * M_PI &&
+             "Increment for expMap must be of norm at most pi");
+  // sin(|v|)/|v| = sinc(h) cos(h) and (1 - cos(|v|))/|v|^2 = sinc(h)^2 / 2
+  // with h = |v|/2
+  double cosH, sincH;
+  halfAngle(n / 4, cosH, sincH);
+  double s = sincH * cosH;
+  double c = 0.5 * sincH * sincH;
+  E << 1 - c*(v.y() * v.y() + v.z() * v.z()), -s * v.z() + c * v.x() * v.y(),
+      s * v.y() + c * v.x() * v.z(), s * v.z() + c * v.x() * v.y(),
+      1 - c * (v.x() * v.x() + v.z() * v.z()), -s * v.x() + c * v.y() * v.z(),
+      -s * v.y() + c * v.x() * v.z(), s * v.x() + c * v.y() * v.z(),
+      1 - c * (v.x() * v.x() + v.y() * v.y());
+}
+
+void FastTrig<ExpMapMatrix>::pseudoLog_(RefVec out, const ConstRefVec& x,
+                                        const ConstRefVec& y)
+{
+  OutputType R(((toConstMat3(x.data())).transpose()) * (toConstMat3(y.data())));
+  logarithm(out, R);
+}
+
+void FastTrig<ExpMapMatrix>::pseudoLog0_(RefVec out, const ConstRefVec& x)
+{
+  OutputType R(toConstMat3(x.data()));
+  logarithm(out, R);
+}
+
+void FastTrig<ExpMapMatrix>::logarithm(RefVec out, const OutputType& R)
+{
+  // log(R) = t/(2 sin(t)) d with d = (R21 - R12, R02 - R20, R10 - R01),
+  // sin(t) = |d|/2 and cos(t) = (tr(R) - 1)/2
+  Eigen::Vector3d d(R(2, 1) - R(1, 2), R(0, 2) - R(2, 0), R(1, 0) - R(0, 1));
+  double s = d.norm() / 2;
+  double c = (R.trace() - 1) / 2;
+  double a = atan2AbsOverY(s, c);
+  // for cos(t) < 0, t = pi - atan2(sin(t), |cos(t)|). At t = pi exactly,
+  // s = 0 and d = 0: the result is 0, as with ExpMapMatrix
+  out = 0.5 * (c < 0 && s > 0 ? M_PI / s - a : a) * d;
+}
+
+void FastTrig<ExpMapQuaternion>::retractation_(RefVec out,
+                                               const ConstRefVec& x,
+                                               const ConstRefVec& v)
+{
+  OutputType q;
+  exponential(q, v);
+  toQuat(out.data())
+      .setProduct(toConstQuat(x.data()),
+                  toConstQuat(q.data()));  // out = x*exp(v)
+}
+
+void FastTrig<ExpMapQuaternion>::exponential(OutputType& q,
+                                             const ConstRefVec& v)
+{
+  mnf_assert(v.size() == 3 && "Increment for expMap must be of size 3");
+  double n2 = v.squaredNorm();
+  mnf_assert(n2 < M_PI * M_PI &&
+             "Increment for expMap must be of norm at most pi");
+  double cosH, sincH;
+  halfAngle(n2 / 4, cosH, sincH);
+  toQuat(q.data()).w() = cosH;
+  toQuat(q.data()).vec() = 0.5 * sincH * v;  // sin(|v|/2)/|v| * v
+}
+
+void FastTrig<ExpMapQuaternion>::pseudoLog_(RefVec out, const ConstRefVec& x,
+                                            const ConstRefVec& y)
+{
+  Eigen::Vector4d tmp;
+  toQuat(tmp.data())
+      .setInverseProduct(toConstQuat(x.data()),
+                         toConstQuat(y.data()));  // x^{-1}*y
+  logarithm(out, tmp);
+}
+
+void FastTrig<ExpMapQuaternion>::pseudoLog0_(RefVec out, const ConstRefVec& x)
+{
+  logarithm(out, x);
+}
+
+void FastTrig<ExpMapQuaternion>::logarithm(RefVec out, const OutputType& v)
+{
+  // log(q) = 2 sign(w) atan2(n, |w|) / n * q.vec(), with n = |q.vec()|
+  const toConstQuat vQ(v.data());
+  double n = vQ.vec().norm();
+  out = (vQ.w() < 0 ? -2 : 2) * atan2AbsOverY(n, vQ.w()) * vQ.vec();
+}
+}
@@ -0,0 +1,129 @@
+// Copyright (c) 2015 CNRS
+// Authors: Stanislas Brossette, Adrien Escande
+
+// This file is part of manifolds
+// manifolds is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+
+// manifolds is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// manifolds. If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef _MANIFOLDS_LANES_H_
+#define _MANIFOLDS_LANES_H_
+
+#include <cmath>
+#include <Eigen/Core>
+#include <manifolds/defs.h>
+
+namespace mnf
+{
+/// \internal Helpers of the batched kernels of the exponential maps. This
+/// header is not installed.
+namespace lanes
+{
+/// \brief Number of columns processed together by the batched kernels.
+/// Each quantity of a block is stored in a fixed size array (structure of
+/// arrays), on which Eigen uses the SIMD instructions available.
+const int BlockSize = 8;
+typedef Eigen::Array<double, BlockSize, 1> Lanes;
+
+/// \brief Evaluates the polynomial sum_i c[i] z^i, c having N entries
+template <int N>
+inline Lanes polynomial(const double(&c)[N], const Lanes& z)
+{
+  Lanes r = Lanes::Constant(c[N - 1]);
+  for (int i = N - 2; i >= 0; --i) r = r * z + c[i];
+  return r;
+}
+
+// Taylor coefficients of cos(h) and sin(h)/h in h^2. With these 11 terms,
+// both series are exact to double precision for |h| <= pi/2 (half of the
+// angle of an exponential). They also cover the small angles, without a
+// branch.
+const double cosCoeffs[] = {1.,
+                            -1. / 2,
+                            1. / 24,
+                            -1. / 720,
+                            1. / 40320,
+                            -1. / 3628800,
+                            1. / 479001600,
+                            -1. / 87178291200.,
+                            1. / 20922789888000.,
+                            -1. / 6402373705728000.,
+                            1. / 2432902008176640000.};
+const double sincCoeffs[] = {1.,
+                             -1. / 6,
+                             1. / 120,
+                             -1. / 5040,
+                             1. / 362880,
+                             -1. / 39916800,
+                             1. / 6227020800.,
+                             -1. / 1307674368000.,
+                             1. / 355687428096000.,
+                             -1. / 121645100408832000.,
+                             1. / 51090942171709440000.};
+
+// Rational approximation of atan from the Cephes library:
+// atan(x) = x + x^3 P(x^2)/Q(x^2) for |x| <= 0.66
+const double atanP[] = {-6.485021904942025371773E1, -1.228866684490136173410E2,
+                        -7.500855792314704667340E1, -1.615753718733365076637E1,
+                        -8.750608600031904122785E-1};
+const double atanQ[] = {1.945506571482613964425E2, 4.853903996359136964868E2,
+                        4.328810604912902668951E2, 1.650270098316988542046E2,
+                        2.485846490142306297962E1, 1.};
+
+/// \brief Computes atan(r)/r for 0 <= r <= 1. Above 0.66, the argument
+/// is reduced with atan(r) = pi/4 + atan((r-1)/(r+1)).
+inline Lanes atanOverX(const Lanes& r)
+{
+  const auto large = r > 0.66;
+  Lanes x = large.select((r - 1) / (r + 1), r);
+  Lanes z = x * x;
+  Lanes p = z * polynomial(atanP, z) / polynomial(atanQ, z);
+  Lanes reduced = (M_PI / 4 + 0.5 * 6.123233995736765886130E-17) + x + x * p;
+  return large.select(reduced / r.max(0.66), 1 + p);
+}
+
+/// \brief Computes atan2(y, |x|)/y for y >= 0, without branches. The value
+/// for y = 0 is the limit 1/|x|.
+inline Lanes atan2AbsOverY(const Lanes& y, const Lanes& x)
+{
+  Lanes ax = x.abs();
+  Lanes hi = y.max(ax);
+  Lanes r = y.min(ax) / hi;
+  Lanes g = atanOverX(r);
+  // if y <= |x|, atan2(y, |x|)/y = atanOverX(y/|x|)/|x|
+  // else atan2(y, |x|)/y = (pi/2 - atan(|x|/y))/y
+  return (y <= ax).select(g, M_PI / 2 - r * g) / hi;
+}
+
+/// \brief Loads the rows of columns [j, j+n) of M in blocks of lanes.
+/// The unused lanes are filled with value.
+template <int Rows>
+inline void load(Lanes (&out)[Rows], const ConstRefMat& M, Index j, Index n,
+                 double value)
+{
+  for (int i = 0; i < Rows; ++i)
+  {
+    out[i].setConstant(value);
+    for (Index k = 0; k < n; ++k) out[i][k] = M(i, j + k);
+  }
+}
+
+template <int Rows>
+inline void store(RefMat M, const Lanes (&in)[Rows], Index j, Index n)
+{
+  for (int i = 0; i < Rows; ++i)
+    for (Index k = 0; k < n; ++k) M(i, j + k) = in[i][k];
+}
+}
+}
+
+#endif  //_MANIFOLDS_LANES_H_
@@ -21,6 +21,59 @@
 
 namespace mnf
 {
+namespace
+{
+/// \internal Triplets of the sparse Jacobians, reused between the calls of a
+/// thread
+std::vector<Triplet>& tripletBuffer()
+{
+  static thread_local std::vector<Triplet> buffer;
+  buffer.clear();
+  return buffer;
+}
+
+/// \internal Copy of in stored by columns, reused between the calls of a
+/// thread
+template <typename SparseType>
+const SparseMat& byColumns(const SparseType& in)
+{
+  static thread_local SparseMat columns;
+  columns = in;
+  return columns;
+}
+
+/// \internal used[k] is the number of the columns of in before column k that
+/// hold nonzeros, see Manifold::isUsed
+const std::vector<Index>& usedColumns(const SparseMat& in)
+{
+  static thread_local std::vector<Index> used;
+  used.resize(static_cast<size_t>(in.cols()) + 1);
+  used[0] = 0;
+  for (size_t k = 0; k + 1 < used.size(); ++k)
+  {
+    bool hit = SparseMat::InnerIterator(in, static_cast<Index>(k));
+    used[k + 1] = used[k] + (hit ? 1 : 0);
+  }
+  return used;
+}
+
+/// \internal out = in * J, with J given by its triplets. Each coefficient of
+/// J is combined with the nonzeros of the matching column of in, so that the
+/// cost does not depend on the dimensions of J.
+template <typename SparseType>
+void multiplyTriplets(SparseType& out, const SparseMat& in,
+                      const std::vector<Triplet>& J, Index cols)
+{
+  static thread_local std::vector<Triplet> product;
+  product.clear();
+  for (const Triplet& t : J)
+    for (SparseMat::InnerIterator it(in, t.row()); it; ++it)
+      product.push_back(Triplet(it.row(), t.col(), it.value() * t.value()));
+  out.resize(in.rows(), cols);
+  out.setFromTriplets(product.begin(), product.end());
+}
+}
+
 long Manifold::manifoldCounter_ = 0;
 
 Manifold::Manifold(Index dimension, Index tangentDimension,
@@ -28,7 +81,8 @@ Manifold::Manifold(Index dimension, Index tangentDimension,
     : dimension_(dimension),
       tangentDim_(tangentDimension),
       representationDim_(representationDimension),
-      lock_(false)
+      lock_(false),
+      pointArena_(0x0)
 {
   mnf_assert(0 <= dimension && "Negative dimension not accepted");
   mnf_assert(dimension <= tangentDimension);
@@ -78,20 +132,24 @@ Point Manifold::getZero() const
 {
   mnf_assert(isValid() || seeMessageAbove());
   lock();
-  Eigen::VectorXd id(representationDim_);
-  setZero(id);
-  return Point(*this, id);
+  Point id(*this);
+  setZero(id.value());
+  return id;
 }
 
 Point Manifold::createRandomPoint(double coeff) const
 {
   mnf_assert(isValid() || seeMessageAbove());
   lock();
-  Eigen::VectorXd val(representationDim_);
-  createRandomPoint(val, coeff);
-  return Point(*this, val);
+  Point val(*this);
+  createRandomPoint(val.value(), coeff);
+  return val;
 }
 
+void Manifold::setPointArena(PointArena* arena) { pointArena_ = arena; }
+
+PointArena* Manifold::pointArena() const { return pointArena_; }
+
 void Manifold::createRandomPoint(RefVec out, double coeff) const
 {
   mnf_assert(out.size() == representationDim_ &&
@@ -136,6 +194,30 @@ void Manifold::retractation(RefVec out, const ConstRefVec& x,
   mnf_assert(isInTxM(x, v) && "Wrong tangent vector provided to retractation");
   retractation_(out, x, v);
 }
+void Manifold::retractationBatch(RefMat out, const ConstRefMat& X,
+                                 const ConstRefMat& V) const
+{
+  mnf_assert(isValid() || seeMessageAbove());
+  mnf_assert(out.rows() == representationDim_);
+  mnf_assert(X.rows() == representationDim_);
+  mnf_assert(V.rows() == tangentDim_);
+  mnf_assert(out.cols() == X.cols());
+  mnf_assert(V.cols() == X.cols());
+#ifndef NDEBUG
+  for (Index j = 0; j < X.cols(); ++j)
+    mnf_assert(isInTxM(X.col(j), V.col(j)) &&
+               "Wrong tangent vector provided to retractationBatch");
+#endif
+  retractationBatch_(out, X, V);
+}
+
+void Manifold::retractationBatch_(RefMat out, const ConstRefMat& X,
+                                  const ConstRefMat& V) const
+{
+  for (Index j = 0; j < X.cols(); ++j)
+    retractation_(out.col(j), X.col(j), V.col(j));
+}
+
 // void Manifold::retractation(RefVec out, const Point& x, const ConstRefVec& v)
 // const
 //{
@@ -162,6 +244,25 @@ void Manifold::pseudoLog(RefVec out, const ConstRefVec& x,
   mnf_assert(y.size() == representationDim_);
   pseudoLog_(out, x, y);
 }
+void Manifold::pseudoLogBatch(RefMat out, const ConstRefMat& X,
+                              const ConstRefMat& Y) const
+{
+  mnf_assert(isValid() || seeMessageAbove());
+  mnf_assert(out.rows() == tangentDim_);
+  mnf_assert(X.rows() == representationDim_);
+  mnf_assert(Y.rows() == representationDim_);
+  mnf_assert(out.cols() == X.cols());
+  mnf_assert(Y.cols() == X.cols());
+  pseudoLogBatch_(out, X, Y);
+}
+
+void Manifold::pseudoLogBatch_(RefMat out, const ConstRefMat& X,
+                               const ConstRefMat& Y) const
+{
+  for (Index j = 0; j < X.cols(); ++j)
+    pseudoLog_(out.col(j), X.col(j), Y.col(j));
+}
+
 // void Manifold::pseudoLog(RefVec out, const Point& x, const Point& y) const
 //{
 //  pseudoLog(out, x.value(), y.value());
@@ -185,6 +286,20 @@ void Manifold::pseudoLog0(RefVec out, const ConstRefVec& x) const
   mnf_assert(x.size() == representationDim_);
   pseudoLog0_(out, x);
 }
+void Manifold::pseudoLog0Batch(RefMat out, const ConstRefMat& X) const
+{
+  mnf_assert(isValid() || seeMessageAbove());
+  mnf_assert(out.rows() == tangentDim_);
+  mnf_assert(X.rows() == representationDim_);
+  mnf_assert(out.cols() == X.cols());
+  pseudoLog0Batch_(out, X);
+}
+
+void Manifold::pseudoLog0Batch_(RefMat out, const ConstRefMat& X) const
+{
+  for (Index j = 0; j < X.cols(); ++j) pseudoLog0_(out.col(j), X.col(j));
+}
+
 // void Manifold::pseudoLog0(RefVec out, const Point& x) const
 //{
 //  pseudoLog0(out, x.value());
@@ -209,6 +324,16 @@ Eigen::MatrixXd Manifold::diffRetractation(const ConstRefVec& x) const
   return diffRetractation_(x);
 }
 
+void Manifold::diffRetractation(SparseMat& out, const ConstRefVec& x) const
+{
+  mnf_assert(isValid() || seeMessageAbove());
+  mnf_assert(x.size() == representationDim_);
+  std::vector<Triplet>& triplets = tripletBuffer();
+  diffRetractationTriplets_(triplets, x, 0, 0, 0x0);
+  out.resize(representationDim_, tangentDim_);
+  out.setFromTriplets(triplets.begin(), triplets.end());
+}
+
 void Manifold::applyDiffRetractation(RefMat out, const ConstRefMat& in,
                                      const ConstRefVec& x) const
 {
@@ -220,6 +345,52 @@ void Manifold::applyDiffRetractation(RefMat out, const ConstRefMat& in,
   applyDiffRetractation_(out, in, x);
 }
 
+void Manifold::applyDiffRetractation(SparseMat& out, const SparseMat& in,
+                                     const ConstRefVec& x) const
+{
+  mnf_assert(isValid() || seeMessageAbove());
+  mnf_assert(in.cols() == representationDim_);
+  mnf_assert(x.size() == representationDim_);
+  applySparseDiffRetractation(out, in, x);
+}
+
+void Manifold::applyDiffRetractation(SparseRowMat& out, const SparseRowMat& in,
+                                     const ConstRefVec& x) const
+{
+  mnf_assert(isValid() || seeMessageAbove());
+  mnf_assert(in.cols() == representationDim_);
+  mnf_assert(x.size() == representationDim_);
+  applySparseDiffRetractation(out, in, x);
+}
+
+void Manifold::retractationWithJacobian(RefVec out, RefMat J,
+                                        const ConstRefVec& x,
+                                        const ConstRefVec& v) const
+{
+  mnf_assert(isValid() || seeMessageAbove());
+  mnf_assert(out.size() == representationDim_);
+  mnf_assert(J.rows() == representationDim_);
+  mnf_assert(J.cols() == tangentDim_);
+  mnf_assert(x.size() == representationDim_);
+  mnf_assert(v.size() == tangentDim_);
+  mnf_assert(isInTxM(x, v) &&
+             "Wrong tangent vector provided to retractationWithJacobian");
+  retractationWithJacobian_(out, J, x, v);
+}
+
+void Manifold::pseudoLogWithJacobian(RefVec out, RefMat Jx, RefMat Jy,
+                                     const ConstRefVec& x,
+                                     const ConstRefVec& y) const
+{
+  mnf_assert(isValid() || seeMessageAbove());
+  mnf_assert(out.size() == tangentDim_);
+  mnf_assert(Jx.rows() == tangentDim_ && Jx.cols() == representationDim_);
+  mnf_assert(Jy.rows() == tangentDim_ && Jy.cols() == representationDim_);
+  mnf_assert(x.size() == representationDim_);
+  mnf_assert(y.size() == representationDim_);
+  pseudoLogWithJacobian_(out, Jx, Jy, x, y);
+}
+
 Eigen::MatrixXd Manifold::diffPseudoLog0(const ConstRefVec& x) const
 {
   mnf_assert(isValid() || seeMessageAbove());
@@ -227,6 +398,16 @@ Eigen::MatrixXd Manifold::diffPseudoLog0(const ConstRefVec& x) const
   return diffPseudoLog0_(x);
 }
 
+void Manifold::diffPseudoLog0(SparseMat& out, const ConstRefVec& x) const
+{
+  mnf_assert(isValid() || seeMessageAbove());
+  mnf_assert(x.size() == representationDim_);
+  std::vector<Triplet>& triplets = tripletBuffer();
+  diffPseudoLog0Triplets_(triplets, x, 0, 0, 0x0);
+  out.resize(tangentDim_, representationDim_);
+  out.setFromTriplets(triplets.begin(), triplets.end());
+}
+
 void Manifold::applyDiffPseudoLog0(RefMat out, const ConstRefMat& in,
                                    const ConstRefVec& x) const
 {
@@ -238,6 +419,65 @@ void Manifold::applyDiffPseudoLog0(RefMat out, const ConstRefMat& in,
   applyDiffPseudoLog0_(out, in, x);
 }
 
+void Manifold::applyDiffPseudoLog0(SparseMat& out, const SparseMat& in,
+                                   const ConstRefVec& x) const
+{
+  mnf_assert(isValid() || seeMessageAbove());
+  mnf_assert(in.cols() == tangentDim_);
+  mnf_assert(x.size() == representationDim_);
+  applySparseDiffPseudoLog0(out, in, x);
+}
+
+void Manifold::applyDiffPseudoLog0(SparseRowMat& out, const SparseRowMat& in,
+                                   const ConstRefVec& x) const
+{
+  mnf_assert(isValid() || seeMessageAbove());
+  mnf_assert(in.cols() == tangentDim_);
+  mnf_assert(x.size() == representationDim_);
+  applySparseDiffPseudoLog0(out, in, x);
+}
+
+template <typename SparseType>
+void Manifold::applySparseDiffRetractation(SparseType& out,
+                                           const SparseType& in,
+                                           const ConstRefVec& x) const
+{
+  // The rows of the Jacobian are multiplied by the columns of in: the blocks
+  // of the submanifolds whose columns are empty are not computed
+  const SparseMat& columns = byColumns(in);
+  std::vector<Triplet>& triplets = tripletBuffer();
+  diffRetractationTriplets_(triplets, x, 0, 0, &usedColumns(columns));
+  multiplyTriplets(out, columns, triplets, tangentDim_);
+}
+
+template <typename SparseType>
+void Manifold::applySparseDiffPseudoLog0(SparseType& out, const SparseType& in,
+                                         const ConstRefVec& x) const
+{
+  const SparseMat& columns = byColumns(in);
+  std::vector<Triplet>& triplets = tripletBuffer();
+  diffPseudoLog0Triplets_(triplets, x, 0, 0, &usedColumns(columns));
+  multiplyTriplets(out, columns, triplets, representationDim_);
+}
+
+void Manifold::diffRetractationTriplets_(std::vector<Triplet>& out,
+                                         const ConstRefVec& x, Index startR,
+                                         Index startT,
+                                         const UsedRows* used) const
+{
+  if (!isUsed(used, startR, representationDim_)) return;
+  appendTriplets(out, diffRetractation_(x), startR, startT);
+}
+
+void Manifold::diffPseudoLog0Triplets_(std::vector<Triplet>& out,
+                                       const ConstRefVec& x, Index startT,
+                                       Index startR,
+                                       const UsedRows* used) const
+{
+  if (!isUsed(used, startT, tangentDim_)) return;
+  appendTriplets(out, diffPseudoLog0_(x), startT, startR);
+}
+
 void Manifold::applyTransport(RefMat out, const ConstRefMat& in,
                               const ConstRefVec& x, const ConstRefVec& v) const
 {
@@ -409,6 +649,8 @@ std::shared_ptr<Manifold> Manifold::getNewCopy() const
   lock();
   std::shared_ptr<Manifold> copy(getNewCopy_());
   copy->instanceId_ = instanceId_;
+  // The arena is set by the user on a given manifold, copies do not share it
+  copy->pointArena_ = 0x0;
   copy->lock();
   return copy;
 }
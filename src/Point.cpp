@@ -16,9 +16,14 @@
 // <http://www.gnu.org/licenses/>.
 
 #include <iostream>
+#include <new>
+#include <utility>
 #include <manifolds/defs.h>
 #include <manifolds/Point.h>
 #include <manifolds/Manifold.h>
+#include <manifolds/PointArena.h>
+#include <manifolds/PointView.h>
+#include <manifolds/ReusableTemporaryMap.h>
 #include <manifolds/mnf_assert.h>
 
 namespace mnf
@@ -26,8 +31,7 @@ namespace mnf
 ConstSubPoint::ConstSubPoint(const Manifold& M, const ConstRefVec& val)
     : manifold_(M),
       value_(Eigen::Map<Eigen::VectorXd>(const_cast<double*>(val.data()),
-                                         val.size())),
-      format_(mnf::defaultFormat)
+                                         val.size()))
 {
   mnf_assert(M.representationDim() == val.size());
   registerPoint();
@@ -53,9 +57,17 @@ ConstSegment ConstSubPoint::operator[](size_t i) const
   return manifold_.getConstView<R>(value_, i);
 }
 
+ConstPointView ConstSubPoint::view() const
+{
+  return ConstPointView(manifold_, value_.data());
+}
+
 const Manifold& ConstSubPoint::getManifold() const { return manifold_; }
 
-const Eigen::IOFormat& ConstSubPoint::format() const { return format_; }
+const Eigen::IOFormat& ConstSubPoint::format() const
+{
+  return format_ ? *format_ : mnf::defaultFormat;
+}
 
 std::string ConstSubPoint::toString(std::string& prefix,
                                     const Eigen::IOFormat& fmt) const
@@ -83,33 +95,100 @@ Segment SubPoint::operator[](size_t i)
   return manifold_.getView<R>(value_, i);
 }
 
-PointMemory::PointMemory(Index size) : mem_(size) {}
+PointView SubPoint::view() { return PointView(manifold_, value_.data()); }
+
+ConstPointView SubPoint::view() const { return ConstSubPoint::view(); }
 
-PointMemory::PointMemory(const ConstRefVec& v) : mem_(v) {}
+PointMemory::PointMemory(Index size, PointArena* arena)
+    : mem_(0x0), size_(size), arena_(arena)
+{
+  allocate();
+}
+
+PointMemory::PointMemory(const ConstRefVec& v, PointArena* arena)
+    : mem_(0x0), size_(v.size()), arena_(arena)
+{
+  allocate();
+  getMem() = v;
+}
 
-Eigen::VectorXd& PointMemory::getMem()
+PointMemory::PointMemory(PointMemory&& other) NOEXCEPT(true)
+    : mem_(other.mem_),
+      size_(other.size_),
+      arena_(other.arena_)
 {
-  mnf_assert(mem_.size() > 0);
-  return mem_;
+  other.mem_ = 0x0;
+  other.size_ = 0;
+}
+
+PointMemory::~PointMemory()
+{
+  if (!mem_) return;
+  if (arena_)
+    arena_->deallocate(mem_, size_);
+  else
+    Eigen::aligned_allocator<double>().deallocate(mem_,
+                                                  static_cast<size_t>(size_));
+}
+
+void PointMemory::allocate()
+{
+  mnf_assert(size_ > 0);
+  if (arena_)
+    mem_ = arena_->allocate(size_);
+  else
+    mem_ = Eigen::aligned_allocator<double>().allocate(
+        static_cast<size_t>(size_));
+}
+
+Eigen::Map<Eigen::VectorXd> PointMemory::getMem()
+{
+  return Eigen::Map<Eigen::VectorXd>(mem_, size_);
+}
+
+void PointMemory::swapMem(PointMemory& other) NOEXCEPT(true)
+{
+  std::swap(mem_, other.mem_);
+  std::swap(size_, other.size_);
+  std::swap(arena_, other.arena_);
 }
 
 Point::Point(const Manifold& M)
-    : PointMemory(M.representationDim()), SubPoint(M, getMem())
+    : PointMemory(M.representationDim(), M.pointArena()),
+      SubPoint(M, getMem())
 {
 }
 
 Point::Point(const Manifold& M, const ConstRefVec& val)
-    : PointMemory(val), SubPoint(M, getMem())
+    : PointMemory(val, M.pointArena()), SubPoint(M, getMem())
 {
 }
 
 Point::Point(const Point& other)
-    : PointMemory(other.value()), SubPoint(other.getManifold(), getMem())
+    : PointMemory(other.value(), other.getManifold().pointArena()),
+      SubPoint(other.getManifold(), getMem())
+{
+}
+
+Point::Point(Point&& other) NOEXCEPT(true)
+    : PointMemory(std::move(other)),
+      SubPoint(static_cast<const SubPoint&>(other))
 {
+  // The copy of the SubPoint skips the size check, that an empty other would
+  // fail in this noexcept constructor. Both views are then rebound.
+  bindMem();
+  other.bindMem();
 }
 
 Point::Point(const ConstSubPoint& other)
-    : PointMemory(other.value()), SubPoint(other.getManifold(), getMem())
+    : PointMemory(other.value(), other.getManifold().pointArena()),
+      SubPoint(other.getManifold(), getMem())
+{
+}
+
+Point::Point(const ConstPointView& other)
+    : PointMemory(other.value(), other.getManifold().pointArena()),
+      SubPoint(other.getManifold(), getMem())
 {
 }
 
@@ -121,9 +200,9 @@ Point& Point::increment(const ConstRefVec& v)
 
 Point Point::retractation(const ConstRefVec& v) const
 {
-  Eigen::VectorXd out(manifold_.representationDim());
-  manifold_.retractation(out, this->value_, v);
-  return manifold_.createPoint(out);
+  Point out(manifold_);
+  manifold_.retractation(out.value(), this->value_, v);
+  return out;
 }
 void Point::retractation(RefVec out, const ConstRefVec& v) const
 {
@@ -171,20 +250,41 @@ Point& Point::operator=(const Point& x)
   mnf_assert(this->manifold_.dim() == x.getManifold().dim());
   mnf_assert(this->manifold_.representationDim() ==
              x.getManifold().representationDim());
+  mnf_assert(this->value_.size() > 0 &&
+             "Cannot copy into a point that was moved from");
   this->value_ = x.value();
   return *this;
 }
 
-Point operator+(const Point& x, const ConstRefVec& v)
+Point& Point::operator=(Point&& x)
+{
+  mnf_assert(this->manifold_.dim() == x.getManifold().dim());
+  mnf_assert(this->manifold_.representationDim() ==
+             x.getManifold().representationDim());
+  mnf_assert(x.value_.size() > 0 &&
+             "Cannot move from a point that was moved from");
+  swapMem(x);
+  bindMem();
+  x.bindMem();
+  return *this;
+}
+
+void Point::bindMem()
 {
-  return x.getManifold().createPoint(x.value()).increment(v);
+  // A Ref cannot be reassigned to new data, so it is rebuilt in place, as
+  // Eigen recommends for Map
+  new (&value_) RefVec(getMem());
 }
 
-Eigen::VectorXd operator-(const Point& x, const Point& y)
+namespace utils
 {
-  Eigen::VectorXd output(x.getManifold().dim());
-  x.getManifold().pseudoLog(output, y.value(), x.value());
-  return output;
+Eigen::Map<Eigen::VectorXd> pointExpressionBuffer(Index size)
+{
+  // Not shared with ReusableTemporaryMap::ofCurrentThread, that the
+  // retractation may use while the expression is evaluated
+  static thread_local ReusableTemporaryMap buffer;
+  return Eigen::Map<Eigen::VectorXd>(buffer.getMap(size, 1).data(), size);
+}
 }
 
 bool Point::isInM(double prec) const { return manifold_.isInM(value_, prec); }
@@ -234,7 +334,7 @@ void Point::applyInvTransport(RefMat out, const ConstRefMat& in,
 
 const Point& Point::format(const Eigen::IOFormat& fmt) const
 {
-  format_ = fmt;
+  format_.reset(new Eigen::IOFormat(fmt));
   return *this;
 }
 }
@@ -0,0 +1,92 @@
+// Copyright (c) 2015 CNRS
+// Authors: Stanislas Brossette, Adrien Escande
+
+// This file is part of manifolds
+// manifolds is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+
+// manifolds is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// manifolds. If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+
+#include <manifolds/PointArena.h>
+#include <manifolds/mnf_assert.h>
+
+namespace mnf
+{
+PointArena::PointArena(size_t slabSize)
+    : slabSize_(slabSize), currentSlab_(0), offset_(0), liveBlocks_(0)
+{
+  mnf_assert(slabSize > 0 && "slabSize must be at least one");
+}
+
+PointArena::~PointArena()
+{
+  for (size_t i = 0; i < slabs_.size(); ++i)
+    allocator_.deallocate(slabs_[i].first, slabs_[i].second);
+}
+
+size_t PointArena::sizeClass(Index size)
+{
+  size_t k = 1;  // blocks have at least two doubles, to stay aligned
+  while ((static_cast<Index>(1) << k) < size) ++k;
+  return k;
+}
+
+double* PointArena::allocate(Index size)
+{
+  mnf_assert(size > 0 && "size must be at least one");
+  size_t k = sizeClass(size);
+  size_t blockSize = static_cast<size_t>(1) << k;
+  ++liveBlocks_;
+  if (k < freeLists_.size() && !freeLists_[k].empty())
+  {
+    double* p = freeLists_[k].back();
+    freeLists_[k].pop_back();
+    return p;
+  }
+
+  // Carve a new block, moving to the next slab if the current one is full
+  while (currentSlab_ < slabs_.size() &&
+         offset_ + blockSize > slabs_[currentSlab_].second)
+  {
+    ++currentSlab_;
+    offset_ = 0;
+  }
+  if (currentSlab_ == slabs_.size())
+  {
+    size_t n = std::max(slabSize_, blockSize);
+    slabs_.push_back(std::make_pair(allocator_.allocate(n), n));
+    offset_ = 0;
+  }
+  double* p = slabs_[currentSlab_].first + offset_;
+  offset_ += blockSize;
+  return p;
+}
+
+void PointArena::deallocate(double* p, Index size)
+{
+  mnf_assert(liveBlocks_ > 0 && "this block was not allocated in the arena");
+  size_t k = sizeClass(size);
+  if (k >= freeLists_.size()) freeLists_.resize(k + 1);
+  freeLists_[k].push_back(p);
+  --liveBlocks_;
+}
+
+void PointArena::reset()
+{
+  mnf_assert(liveBlocks_ == 0 &&
+             "You cannot reset this arena because some points still use it");
+  for (size_t k = 0; k < freeLists_.size(); ++k) freeLists_[k].clear();
+  currentSlab_ = 0;
+  offset_ = 0;
+}
+}
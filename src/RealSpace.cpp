@@ -102,14 +102,31 @@ void RealSpace::retractation_(RefVec out, const ConstRefVec& x,
   out = x + v;
 }
 
+void RealSpace::retractationBatch_(RefMat out, const ConstRefMat& X,
+                                   const ConstRefMat& V) const
+{
+  out = X + V;
+}
+
 void RealSpace::pseudoLog_(RefVec out, const ConstRefVec& x,
                            const ConstRefVec& y) const
 {
   out = y - x;
 }
 
+void RealSpace::pseudoLogBatch_(RefMat out, const ConstRefMat& X,
+                                const ConstRefMat& Y) const
+{
+  out = Y - X;
+}
+
 void RealSpace::pseudoLog0_(RefVec out, const ConstRefVec& x) const { out = x; }
 
+void RealSpace::pseudoLog0Batch_(RefMat out, const ConstRefMat& X) const
+{
+  out = X;
+}
+
 void RealSpace::setZero_(RefVec out) const { out.setZero(); }
 
 Eigen::MatrixXd RealSpace::diffRetractation_(const ConstRefVec&) const
@@ -117,6 +134,24 @@ Eigen::MatrixXd RealSpace::diffRetractation_(const ConstRefVec&) const
   return Eigen::MatrixXd::Identity(representationDim(), dim());
 }
 
+void RealSpace::retractationWithJacobian_(RefVec out, RefMat J,
+                                          const ConstRefVec& x,
+                                          const ConstRefVec& v) const
+{
+  out = x + v;
+  J.setIdentity();
+}
+
+void RealSpace::pseudoLogWithJacobian_(RefVec out, RefMat Jx, RefMat Jy,
+                                       const ConstRefVec& x,
+                                       const ConstRefVec& y) const
+{
+  out = y - x;
+  Jx.setIdentity();
+  Jx *= -1;
+  Jy.setIdentity();
+}
+
 void RealSpace::applyDiffRetractation_(RefMat out, const ConstRefMat& in,
                                        const ConstRefVec&) const
 {
@@ -134,6 +169,26 @@ void RealSpace::applyDiffPseudoLog0_(RefMat out, const ConstRefMat& in,
   out = in;
 }
 
+void RealSpace::diffRetractationTriplets_(std::vector<Triplet>& out,
+                                          const ConstRefVec& x, Index startR,
+                                          Index startT,
+                                          const UsedRows* used) const
+{
+  for (Index i = 0; i < x.size(); ++i)
+    if (isUsed(used, startR + i, 1))
+      out.push_back(Triplet(startR + i, startT + i, 1));
+}
+
+void RealSpace::diffPseudoLog0Triplets_(std::vector<Triplet>& out,
+                                        const ConstRefVec& x, Index startT,
+                                        Index startR,
+                                        const UsedRows* used) const
+{
+  for (Index i = 0; i < x.size(); ++i)
+    if (isUsed(used, startT + i, 1))
+      out.push_back(Triplet(startT + i, startR + i, 1));
+}
+
 void RealSpace::applyTransport_(RefMat out, const ConstRefMat& in,
                                 const ConstRefVec&, const ConstRefVec&) const
 {
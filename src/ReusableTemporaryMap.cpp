@@ -38,6 +38,12 @@ ReusableTemporaryMap::~ReusableTemporaryMap()
   allocator_.deallocate(buffer_, size_);
 }
 
+ReusableTemporaryMap& ReusableTemporaryMap::ofCurrentThread()
+{
+  static thread_local ReusableTemporaryMap buffer;
+  return buffer;
+}
+
 void ReusableTemporaryMap::allocate_(size_t size)
 {
   mnf_assert(buffer_ == 0x0);
@@ -15,12 +15,14 @@
 // manifolds. If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
 #include <limits>
 #define _USE_MATH_DEFINES
 #include <math.h>
 
 #include <manifolds/utils.h>
 #include <manifolds/S2.h>
+#include <manifolds/ReusableTemporaryMap.h>
 #include <manifolds/mnf_assert.h>
 
 namespace mnf
@@ -30,6 +32,7 @@ S2::S2() : Manifold(2, 3, 3)
   name() = "S2";
   setTypicalMagnitude(Eigen::Vector3d::Constant(M_PI));
   setTrustMagnitude(Eigen::Vector3d::Constant(M_PI));
+  warmUpScratchMemory();
 }
 
 S2::S2(double magnitude) : Manifold(2, 3, 3)
@@ -37,6 +40,7 @@ S2::S2(double magnitude) : Manifold(2, 3, 3)
   name() = "S2";
   setTypicalMagnitude(Eigen::Vector3d::Constant(magnitude));
   setTrustMagnitude(Eigen::Vector3d::Constant(magnitude));
+  warmUpScratchMemory();
 }
 S2::S2(const ConstRefVec& magnitude) : Manifold(2, 3, 3)
 {
@@ -44,8 +48,11 @@ S2::S2(const ConstRefVec& magnitude) : Manifold(2, 3, 3)
   name() = "S2";
   setTypicalMagnitude(magnitude);
   setTrustMagnitude(magnitude);
+  warmUpScratchMemory();
 }
 
+void S2::warmUpScratchMemory() { ReusableTemporaryMap::ofCurrentThread(); }
+
 bool S2::isInM_(const Eigen::VectorXd& val, double prec) const
 {
   bool out(fabs(val.lpNorm<2>() - 1.0) < prec);
@@ -93,12 +100,26 @@ void S2::retractation_(RefVec out, const ConstRefVec& x,
   out = sum / sum.lpNorm<2>();
 }
 
+void S2::retractationBatch_(RefMat out, const ConstRefMat& X,
+                            const ConstRefMat& V) const
+{
+  out = X + V;
+  for (Index j = 0; j < out.cols(); ++j) out.col(j) /= out.col(j).norm();
+}
+
 void S2::pseudoLog_(RefVec out, const ConstRefVec& x,
                     const ConstRefVec& y) const
 {
   logarithm(out, x, y);
 }
 
+void S2::pseudoLogBatch_(RefMat out, const ConstRefMat& X,
+                         const ConstRefMat& Y) const
+{
+  for (Index j = 0; j < X.cols(); ++j)
+    logarithm(out.col(j), X.col(j), Y.col(j));
+}
+
 void S2::logarithm(RefVec out, const ConstRefVec& x, const ConstRefVec& y) const
 {
   Eigen::Vector3d diff, projDiff;
@@ -150,9 +171,16 @@ Eigen::Vector3d S2::randVec(const ConstRefVec& x) const
   return out;
 }
 
-void S2::pseudoLog0_(RefVec, const ConstRefVec&) const
+void S2::pseudoLog0_(RefVec out, const ConstRefVec& x) const
 {
-  throw std::runtime_error("Unimplemented method in S2");
+  // logarithm(e, x) with e = (1, 0, 0) the point given by setZero: the
+  // projection of x - e on TeM is (0, x1, x2)
+  double n = x.tail<2>().norm();
+  out[0] = 0;
+  if (n < 1e-12)
+    out.tail<2>() = x.tail<2>();
+  else
+    out.tail<2>() = (std::acos(x[0]) / n) * x.tail<2>();
 }
 
 void S2::setZero_(RefVec out) const
@@ -162,10 +190,62 @@ void S2::setZero_(RefVec out) const
   out << 1.0, 0.0, 0.0;
 }
 
-Eigen::MatrixXd S2::diffRetractation_(const ConstRefVec& out) const
+Eigen::MatrixXd S2::diffRetractation_(const ConstRefVec& x) const
 {
-  throw std::runtime_error("Unimplemented method in S2");
-  return out;
+  // derivative of (x+v)/|x+v| at v = 0, the projection on TxM
+  Eigen::Matrix3d J;
+  getIdentityOnTxM_(J, x);
+  return J;
+}
+
+void S2::retractationWithJacobian_(RefVec out, RefMat J, const ConstRefVec& x,
+                                   const ConstRefVec& v) const
+{
+  Eigen::Vector3d sum;
+  sum = x + v;
+  double n = sum.lpNorm<2>();
+  Eigen::Vector3d y = sum / n;
+  // derivative of sum/|sum|
+  J = (Eigen::Matrix3d::Identity() - y * y.transpose()) / n;
+  out = y;
+}
+
+void S2::pseudoLogWithJacobian_(RefVec out, RefMat Jx, RefMat Jy,
+                                const ConstRefVec& xIn,
+                                const ConstRefVec& yIn) const
+{
+  const Eigen::Vector3d x = xIn;
+  const Eigen::Vector3d y = yIn;
+  // log_x(y) = theta*u/|u|, with u = diff - (x.diff)*x the projection of
+  // diff = y - x on TxM, and theta = acos(x.y) as in logarithm
+  Eigen::Vector3d diff = y - x;
+  double c = x.dot(diff);
+  Eigen::Vector3d u = diff - c * x;
+  Eigen::Matrix3d dudx, dudy;
+  dudy = Eigen::Matrix3d::Identity() - x * x.transpose();
+  dudx = -(1 + c) * Eigen::Matrix3d::Identity() - x * (diff - x).transpose();
+
+  double d = x.dot(y);
+  double sn = std::sqrt(std::max(0., 1 - d * d));
+  double n = u.norm();
+  if (n < 1e-12 || sn < 1e-12)
+  {
+    // for y close to x, log_x(y) = u up to the second order
+    out = u;
+    Jx = dudx;
+    Jy = dudy;
+    return;
+  }
+  double theta = std::acos(d);
+  Eigen::Vector3d e = u / n;
+  Eigen::Matrix3d P = (theta / n) * (Eigen::Matrix3d::Identity() -
+                                     e * e.transpose());  // d(theta*e)/du
+  // dtheta/dx = -y/sin(theta), dtheta/dy = -x/sin(theta)
+  Jx.noalias() = (-1 / sn) * e * y.transpose();
+  Jx.noalias() += P * dudx;
+  Jy.noalias() = (-1 / sn) * e * x.transpose();
+  Jy.noalias() += P * dudy;
+  out = theta * e;
 }
 
 void S2::applyDiffRetractation_(RefMat out, const ConstRefMat& in,
@@ -174,59 +254,126 @@ void S2::applyDiffRetractation_(RefMat out, const ConstRefMat& in,
   projRows(out, in, x);
 }
 
-Eigen::MatrixXd S2::diffPseudoLog0_(const ConstRefVec& out) const
+Eigen::MatrixXd S2::diffPseudoLog0_(const ConstRefVec& x) const
 {
-  throw std::runtime_error("Unimplemented method in S2");
-  return out;
+  Eigen::Matrix3d J;
+  diffLogarithm0(J, x);
+  return J;
 }
 
-void S2::applyDiffPseudoLog0_(RefMat, const ConstRefMat&,
-                              const ConstRefVec&) const
+void S2::applyDiffPseudoLog0_(RefMat out, const ConstRefMat& in,
+                              const ConstRefVec& x) const
 {
-  throw std::runtime_error("Unimplemented method in S2");
+  Eigen::Matrix3d J;
+  diffLogarithm0(J, x);
+  Eigen::Map<Eigen::MatrixXd, Eigen::Aligned> a =
+      ReusableTemporaryMap::ofCurrentThread().getMap(in.rows(), 3);
+  a.noalias() = in * J;
+  out = a;
 }
 
-void S2::applyTransport_(RefMat out, const ConstRefMat& in,
-                         const ConstRefVec& x, const ConstRefVec& v) const
+void S2::diffRetractationTriplets_(std::vector<Triplet>& out,
+                                   const ConstRefVec& x, Index startR,
+                                   Index startT, const UsedRows* used) const
+{
+  if (!isUsed(used, startR, 3)) return;
+  Eigen::Matrix3d J;
+  getIdentityOnTxM_(J, x);
+  appendTriplets(out, J, startR, startT);
+}
+
+void S2::diffPseudoLog0Triplets_(std::vector<Triplet>& out,
+                                 const ConstRefVec& x, Index startT,
+                                 Index startR, const UsedRows* used) const
+{
+  if (!isUsed(used, startT, 3)) return;
+  Eigen::Matrix3d J;
+  diffLogarithm0(J, x);
+  appendTriplets(out, J, startT, startR);
+}
+
+void S2::diffLogarithm0(Eigen::Matrix3d& J, const ConstRefVec& x) const
 {
-  Eigen::Vector3d y;
-  retractation(y, x, v);
-  Eigen::Matrix3d R = utils::computeRotBetweenVec(x, y);
-  Eigen::Vector3d tmp;
-  for (Index i = 0; i < in.cols(); ++i)
+  // pseudoLogWithJacobian_ with x = e = (1, 0, 0): u = (0, x1, x2) and
+  // theta = acos(x0) only depend on x0 and on (x1, x2) respectively
+  J.setZero();
+  double n = x.tail<2>().norm();
+  double sn = std::sqrt(std::max(0., 1 - x[0] * x[0]));
+  if (n < 1e-12 || sn < 1e-12)
   {
-    tmp = R * in.col(i);
-    out.col(i) = tmp;
+    J.bottomRightCorner<2, 2>().setIdentity();
+    return;
   }
+  Eigen::Vector2d e = x.tail<2>() / n;
+  J.bottomLeftCorner<2, 1>() = (-1 / sn) * e;
+  J.bottomRightCorner<2, 2>() =
+      (std::acos(x[0]) / n) *
+      (Eigen::Matrix2d::Identity() - e * e.transpose());
+}
+
+void S2::applyTransport_(RefMat out, const ConstRefMat& in,
+                         const ConstRefVec& x, const ConstRefVec& v) const
+{
+  transport_(x, v).applyTransport(out, in);
 }
 
 void S2::applyInvTransport_(RefMat out, const ConstRefMat& in,
                             const ConstRefVec& x, const ConstRefVec& v) const
 {
-  Eigen::Vector3d y;
-  retractation(y, x, v);
-  Eigen::Matrix3d R = utils::computeRotBetweenVec(x, y);
-  Eigen::Vector3d tmp;
-  for (Index i = 0; i < in.cols(); ++i)
-  {
-    tmp = R.transpose() * in.col(i);
-    out.col(i) = tmp;
-  }
+  transport_(x, v).applyInvTransport(out, in);
 }
 
 void S2::applyInvTransportOnTheRight_(RefMat out, const ConstRefMat& in,
                                       const ConstRefVec& x,
                                       const ConstRefVec& v) const
 {
-  Eigen::Vector3d y;
-  retractation(y, x, v);
-  Eigen::Matrix3d R = utils::computeRotBetweenVec(x, y);
-  Eigen::Matrix<double, 3, 1> tmp;
-  for (Index i = 0; i < in.rows(); ++i)
-  {
-    tmp = in.row(i) * R.transpose();
-    out.row(i) = tmp;
-  }
+  transport_(x, v).applyInvTransportOnTheRight(out, in);
+}
+
+S2::Transport S2::transport(const ConstRefVec& x, const ConstRefVec& v) const
+{
+  mnf_assert(isValid() || seeMessageAbove());
+  mnf_assert(x.size() == 3);
+  mnf_assert(v.size() == 3);
+  mnf_assert(isInTxM(x, v));
+  return transport_(x, v);
+}
+
+S2::Transport S2::transport_(const ConstRefVec& x, const ConstRefVec& v) const
+{
+  Transport T;
+  retractation_(T.y_, x, v);
+  T.R_ = utils::computeRotBetweenVec(x, T.y_);
+  return T;
+}
+
+void S2::Transport::applyTransport(RefMat out, const ConstRefMat& in) const
+{
+  mnf_assert(in.rows() == 3 && out.rows() == 3 && in.cols() == out.cols());
+  // in and out may be the same matrix
+  Eigen::Map<Eigen::MatrixXd, Eigen::Aligned> a =
+      ReusableTemporaryMap::ofCurrentThread().getMap(3, in.cols());
+  a.noalias() = R_ * in;
+  out = a;
+}
+
+void S2::Transport::applyInvTransport(RefMat out, const ConstRefMat& in) const
+{
+  mnf_assert(in.rows() == 3 && out.rows() == 3 && in.cols() == out.cols());
+  Eigen::Map<Eigen::MatrixXd, Eigen::Aligned> a =
+      ReusableTemporaryMap::ofCurrentThread().getMap(3, in.cols());
+  a.noalias() = R_.transpose() * in;
+  out = a;
+}
+
+void S2::Transport::applyInvTransportOnTheRight(RefMat out,
+                                                const ConstRefMat& in) const
+{
+  mnf_assert(in.cols() == 3 && out.cols() == 3 && in.rows() == out.rows());
+  Eigen::Map<Eigen::MatrixXd, Eigen::Aligned> a =
+      ReusableTemporaryMap::ofCurrentThread().getMap(in.rows(), 3);
+  a.noalias() = in * R_.transpose();
+  out = a;
 }
 
 void S2::tangentConstraint_(RefMat out, const ConstRefVec& x) const
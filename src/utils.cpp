@@ -45,15 +45,20 @@ void hat2(Eigen::Matrix3d& M, const Eigen::Vector3d& v)
 Eigen::Matrix3d computeRotBetweenVec(const Eigen::Vector3d& x,
                                      const Eigen::Vector3d& y)
 {
-  Eigen::Vector3d acrossb = x.cross(y);
+  Eigen::Vector3d c = x.cross(y);
   double adotb = x.dot(y);
   assert(1 + adotb > 1e-12);
-  Eigen::Matrix3d acrossbHat;
-  Eigen::Matrix3d acrossbHat2;
-  utils::hat(acrossbHat, acrossb);
-  utils::hat2(acrossbHat2, acrossb);
+  // R = I + [c]x + [c]x^2/(1 + x.y), with [c]x^2 = c*c^T - |c|^2 I
+  double f = 1 / (1 + adotb);
   Eigen::Matrix3d R;
-  R = Eigen::Matrix3d::Identity() + acrossbHat + acrossbHat2 / (1 + adotb);
+  R.noalias() = f * c * c.transpose();
+  R.diagonal().array() += 1 - f * c.squaredNorm();
+  R(0, 1) -= c.z();
+  R(0, 2) += c.y();
+  R(1, 0) += c.z();
+  R(1, 2) -= c.x();
+  R(2, 0) -= c.y();
+  R(2, 1) += c.x();
   return R;
 }
 
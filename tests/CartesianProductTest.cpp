@@ -26,6 +26,8 @@
 #include <manifolds/RealSpace.h>
 #include <manifolds/CartesianProduct.h>
 #include <manifolds/CartesianPower.h>
+#include <manifolds/CayleyMapMatrix.h>
+#include <manifolds/CayleyMapQuaternion.h>
 #include <manifolds/Point.h>
 #include <manifolds/ExpMapMatrix.h>
 #include <manifolds/ExpMapQuaternion.h>
@@ -392,6 +394,170 @@ BOOST_AUTO_TEST_CASE(CardProdDiffInv)
   BOOST_CHECK(J.isApprox(Jtest));
 }
 
+BOOST_AUTO_TEST_CASE(CardProdSparseDiff)
+{
+  RealSpace R2(2);
+  RealSpace R3(3);
+  SO3<ExpMapMatrix> so3M;
+  SO3<ExpMapQuaternion> so3Q;
+  CartesianProduct P(R3, so3Q);
+  S2 s2;
+  CartesianPower Pow(so3M, 3);
+  CartesianProduct S{&R2, &R3, &so3M, &so3M, &s2};
+  S.multiply(P);
+  S.multiply(Pow);
+  Eigen::VectorXd x(S.representationDim());
+  S.createRandomPoint(x);
+
+  SparseMat J;
+  S.diffRetractation(J, x);
+  BOOST_CHECK_EQUAL(J.rows(), S.representationDim());
+  BOOST_CHECK_EQUAL(J.cols(), S.tangentDim());
+  BOOST_CHECK(Eigen::MatrixXd(J).isApprox(S.diffRetractation(x)));
+
+  SparseMat Jinv;
+  S.diffPseudoLog0(Jinv, x);
+  BOOST_CHECK_EQUAL(Jinv.rows(), S.tangentDim());
+  BOOST_CHECK_EQUAL(Jinv.cols(), S.representationDim());
+  BOOST_CHECK(Eigen::MatrixXd(Jinv).isApprox(S.diffPseudoLog0(x)));
+
+  // Only the diagonal blocks are stored: identity for the real spaces, 9x3
+  // for SO3<ExpMapMatrix>, 3x3 for S2 and 4x3 for SO3<ExpMapQuaternion>
+  Index nnz = 2 + 3 + 5 * 27 + 9 + 3 + 12;
+  BOOST_CHECK_EQUAL(J.nonZeros(), nnz);
+  BOOST_CHECK_EQUAL(Jinv.nonZeros(), nnz);
+}
+
+BOOST_AUTO_TEST_CASE(CardProdSparseApplyDiff)
+{
+  RealSpace R3(3);
+  SO3<ExpMapMatrix> so3M;
+  SO3<ExpMapQuaternion> so3Q;
+  CartesianProduct S{&R3, &so3M, &so3Q, &R3, &so3M};
+  Eigen::VectorXd x(S.representationDim());
+  S.createRandomPoint(x);
+
+  // Sparse constraints: each row only depends on a few variables
+  const Index c = 6;
+  Eigen::MatrixXd dense = Eigen::MatrixXd::Zero(c, S.representationDim());
+  dense(0, 1) = 1;
+  dense(1, 5) = -2;
+  dense(1, 6) = 0.5;
+  dense(3, 20) = 3;
+  dense(5, S.representationDim() - 1) = 4;
+  SparseMat in = dense.sparseView();
+  SparseRowMat inRow = dense.sparseView();
+  Eigen::MatrixXd expected(c, S.tangentDim());
+  S.applyDiffRetractation(expected, dense, x);
+
+  SparseMat out;
+  S.applyDiffRetractation(out, in, x);
+  BOOST_CHECK(Eigen::MatrixXd(out).isApprox(expected));
+  SparseRowMat outRow;
+  S.applyDiffRetractation(outRow, inRow, x);
+  BOOST_CHECK(Eigen::MatrixXd(outRow).isApprox(expected));
+  // the rows without coefficients stay empty
+  BOOST_CHECK_EQUAL(outRow.row(2).nonZeros(), 0);
+  BOOST_CHECK_EQUAL(outRow.row(4).nonZeros(), 0);
+
+  Eigen::MatrixXd denseT = Eigen::MatrixXd::Zero(c, S.tangentDim());
+  denseT(0, 0) = 1;
+  denseT(2, 4) = 2;
+  denseT(4, 7) = -1;
+  denseT(5, S.tangentDim() - 1) = 0.5;
+  SparseMat inT = denseT.sparseView();
+  SparseRowMat inTRow = denseT.sparseView();
+  Eigen::MatrixXd expectedInv(c, S.representationDim());
+  S.applyDiffPseudoLog0(expectedInv, denseT, x);
+  SparseMat outInv;
+  S.applyDiffPseudoLog0(outInv, inT, x);
+  BOOST_CHECK(Eigen::MatrixXd(outInv).isApprox(expectedInv));
+  SparseRowMat outInvRow;
+  S.applyDiffPseudoLog0(outInvRow, inTRow, x);
+  BOOST_CHECK(Eigen::MatrixXd(outInvRow).isApprox(expectedInv));
+}
+
+// A real space whose sparse Jacobians go through the dense default
+// implementation, counting the evaluations of the Jacobians
+class CountingSpace : public RealSpace
+{
+ public:
+  explicit CountingSpace(Index n) : RealSpace(n) {}
+  static int calls;
+
+ protected:
+  virtual Eigen::MatrixXd diffRetractation_(const ConstRefVec& x) const
+  {
+    ++calls;
+    return RealSpace::diffRetractation_(x);
+  }
+  virtual Eigen::MatrixXd diffPseudoLog0_(const ConstRefVec& x) const
+  {
+    ++calls;
+    return RealSpace::diffPseudoLog0_(x);
+  }
+  virtual void diffRetractationTriplets_(std::vector<Triplet>& out,
+                                         const ConstRefVec& x, Index startR,
+                                         Index startT,
+                                         const UsedRows* used) const
+  {
+    Manifold::diffRetractationTriplets_(out, x, startR, startT, used);
+  }
+  virtual void diffPseudoLog0Triplets_(std::vector<Triplet>& out,
+                                       const ConstRefVec& x, Index startT,
+                                       Index startR,
+                                       const UsedRows* used) const
+  {
+    Manifold::diffPseudoLog0Triplets_(out, x, startT, startR, used);
+  }
+  virtual std::shared_ptr<Manifold> getNewCopy_() const
+  {
+    std::shared_ptr<CountingSpace> copy(new CountingSpace(*this));
+    return copy;
+  }
+};
+int CountingSpace::calls = 0;
+
+BOOST_AUTO_TEST_CASE(CardProdSparseApplyDiffSkipsLeaves)
+{
+  // One constraint on 2 of the factors: only their blocks are evaluated
+  CountingSpace C3(3);
+  CartesianPower Pow(C3, 1000);
+  SO3<ExpMapMatrix> so3M;
+  CartesianProduct S(Pow, so3M);
+  Eigen::VectorXd x(S.representationDim());
+  S.createRandomPoint(x);
+  Eigen::MatrixXd dense = Eigen::MatrixXd::Zero(1, S.representationDim());
+  dense(0, 4) = 1;
+  dense(0, 2998) = -1;
+  SparseMat in = dense.sparseView();
+  SparseRowMat inRow = dense.sparseView();
+  Eigen::MatrixXd expected(1, S.tangentDim());
+  S.applyDiffRetractation(expected, dense, x);
+
+  CountingSpace::calls = 0;
+  SparseMat out;
+  S.applyDiffRetractation(out, in, x);
+  BOOST_CHECK_EQUAL(CountingSpace::calls, 2);
+  BOOST_CHECK(Eigen::MatrixXd(out).isApprox(expected));
+  SparseRowMat outRow;
+  S.applyDiffRetractation(outRow, inRow, x);
+  BOOST_CHECK_EQUAL(CountingSpace::calls, 4);
+  BOOST_CHECK(Eigen::MatrixXd(outRow).isApprox(expected));
+
+  Eigen::MatrixXd denseT = Eigen::MatrixXd::Zero(1, S.tangentDim());
+  denseT(0, 7) = 2;
+  denseT(0, S.tangentDim() - 1) = 1;
+  SparseRowMat inTRow = denseT.sparseView();
+  Eigen::MatrixXd expectedInv(1, S.representationDim());
+  S.applyDiffPseudoLog0(expectedInv, denseT, x);
+  CountingSpace::calls = 0;
+  SparseRowMat outInvRow;
+  S.applyDiffPseudoLog0(outInvRow, inTRow, x);
+  BOOST_CHECK_EQUAL(CountingSpace::calls, 1);
+  BOOST_CHECK(Eigen::MatrixXd(outInvRow).isApprox(expectedInv));
+}
+
 BOOST_AUTO_TEST_CASE(CardProdApplyInvDiff)
 {
   int c = 5;
@@ -573,6 +739,609 @@ BOOST_AUTO_TEST_CASE(isSameTopology)
   BOOST_CHECK(cp2.isSameTopology(cp2b));
 }
 
+BOOST_AUTO_TEST_CASE(CardProdRetractationBatch)
+{
+  const Index N = 20;
+  RealSpace R3(3);
+  S2 s2;
+  SO3<ExpMapMatrix> so3M;
+  SO3<ExpMapQuaternion> so3Q;
+  CartesianProduct R3SO3(R3, so3Q);
+  CartesianProduct S2SO3(s2, so3M);
+  CartesianProduct S(R3SO3, S2SO3);
+  Eigen::MatrixXd X(S.representationDim(), N);
+  Eigen::MatrixXd V(S.tangentDim(), N);
+  Eigen::MatrixXd Z(S.representationDim(), N);
+  Eigen::VectorXd z(S.representationDim());
+  for (Index j = 0; j < N; ++j)
+  {
+    S.createRandomPoint(X.col(j));
+    S.forceOnTxM(V.col(j), 0.5 * Eigen::VectorXd::Random(S.tangentDim()),
+                 X.col(j));
+  }
+  S.retractationBatch(Z, X, V);
+  for (Index j = 0; j < N; ++j)
+  {
+    S.retractation(z, X.col(j), V.col(j));
+    BOOST_CHECK(z.isApprox(Z.col(j)));
+  }
+
+  // in place
+  S.retractationBatch(X, X, V);
+  BOOST_CHECK(X.isApprox(Z));
+}
+
+BOOST_AUTO_TEST_CASE(CardProdPseudoLogBatch)
+{
+  const Index N = 20;
+  RealSpace R3(3);
+  S2 s2;
+  SO3<ExpMapMatrix> so3M;
+  SO3<ExpMapQuaternion> so3Q;
+  CartesianProduct R3SO3(R3, so3Q);
+  CartesianProduct S2SO3(s2, so3M);
+  CartesianProduct S(R3SO3, S2SO3);
+  Eigen::MatrixXd X(S.representationDim(), N);
+  Eigen::MatrixXd Y(S.representationDim(), N);
+  Eigen::MatrixXd D(S.tangentDim(), N);
+  Eigen::VectorXd d(S.tangentDim());
+  for (Index j = 0; j < N; ++j)
+  {
+    S.createRandomPoint(X.col(j));
+    S.createRandomPoint(Y.col(j));
+  }
+  S.pseudoLogBatch(D, X, Y);
+  for (Index j = 0; j < N; ++j)
+  {
+    S.pseudoLog(d, X.col(j), Y.col(j));
+    BOOST_CHECK(d.isApprox(D.col(j)));
+  }
+
+  S.pseudoLog0Batch(D, X);
+  for (Index j = 0; j < N; ++j)
+  {
+    S.pseudoLog0(d, X.col(j));
+    BOOST_CHECK(d.isApprox(D.col(j)));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(CardProdNestedFlattening)
+{
+  // The operations of S are dispatched to its leaves directly, we check that
+  // they match the ones of its subproducts
+  RealSpace R2(2);
+  RealSpace R3(3);
+  S2 s2;
+  SO3<ExpMapMatrix> so3M;
+  SO3<ExpMapQuaternion> so3Q;
+  CartesianProduct P1(R3, so3Q);
+  CartesianProduct P2(s2, so3M);
+  CartesianProduct P3(P2, R2);
+  CartesianProduct P4(P1, P3);
+  CartesianProduct S(P4, so3M);
+  S.multiply(R3);
+
+  Eigen::VectorXd x(S.representationDim());
+  Eigen::VectorXd v(S.tangentDim());
+  Eigen::VectorXd z(S.representationDim());
+  Eigen::VectorXd d(S.tangentDim());
+  S.createRandomPoint(x);
+  S.forceOnTxM(v, Eigen::VectorXd::Random(S.tangentDim()), x);
+  BOOST_CHECK(S.isInTxM(x, v));
+
+  S.retractation(z, x, v);
+  for (size_t i = 0; i < S.numberOfSubManifolds(); ++i)
+  {
+    Eigen::VectorXd zi(S(i).representationDim());
+    S(i).retractation(zi, S.getView<R>(x, i), S.getView<T>(v, i));
+    BOOST_CHECK(zi.isApprox(S.getView<R>(z, i)));
+  }
+
+  S.pseudoLog(d, x, z);
+  for (size_t i = 0; i < S.numberOfSubManifolds(); ++i)
+  {
+    Eigen::VectorXd di(S(i).tangentDim());
+    S(i).pseudoLog(di, S.getView<R>(x, i), S.getView<R>(z, i));
+    BOOST_CHECK(di.isApprox(S.getView<T>(d, i)));
+  }
+
+  Eigen::MatrixXd J(4, S.representationDim());
+  Eigen::MatrixXd Jt(4, S.tangentDim());
+  J.setRandom();
+  S.applyDiffRetractation(Jt, J, z);
+  for (size_t i = 0; i < S.numberOfSubManifolds(); ++i)
+  {
+    Eigen::MatrixXd Ji(4, S(i).tangentDim());
+    S(i).applyDiffRetractation(Ji, S.getView<F, R>(J, i), S.getView<R>(z, i));
+    BOOST_CHECK(Ji.isApprox(S.getView<F, T>(Jt, i)));
+  }
+
+  Eigen::MatrixXd M = Eigen::MatrixXd::Random(S.tangentDim(), 4);
+  Eigen::MatrixXd Mt(S.tangentDim(), 4);
+  S.applyTransport(Mt, M, x, v);
+  for (size_t i = 0; i < S.numberOfSubManifolds(); ++i)
+  {
+    Eigen::MatrixXd Mi(S(i).tangentDim(), 4);
+    S(i).applyTransport(Mi, S.getView<T, F>(M, i), S.getView<R>(x, i),
+                        S.getView<T>(v, i));
+    BOOST_CHECK(Mi.isApprox(S.getView<T, F>(Mt, i)));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(CardProdHomogeneousRuns)
+{
+  // Consecutive manifolds of the same type are processed as a single run, and
+  // adjacent real spaces are merged. We check that the results match the ones
+  // of the submanifolds.
+  RealSpace R2(2);
+  RealSpace R3(3);
+  S2 s2;
+  SO3<ExpMapQuaternion> so3Q;
+  SO3<ExpMapMatrix> so3M;
+  CartesianProduct P{&R3, &so3Q, &so3Q};
+  CartesianProduct S{&R2, &R3, &so3Q, &so3Q, &so3Q, &so3M, &R3, &s2, &s2};
+  S.multiply(P);
+  S.multiply(R2);
+
+  Eigen::VectorXd x(S.representationDim());
+  Eigen::VectorXd y(S.representationDim());
+  Eigen::VectorXd v(S.tangentDim());
+  Eigen::VectorXd z(S.representationDim());
+  Eigen::VectorXd d(S.tangentDim());
+  S.createRandomPoint(x);
+  S.createRandomPoint(y);
+  S.forceOnTxM(v, Eigen::VectorXd::Random(S.tangentDim()), x);
+  BOOST_CHECK(S.isInTxM(x, v));
+  S.retractation(z, x, v);
+  S.pseudoLog(d, x, y);
+  Eigen::MatrixXd J = Eigen::MatrixXd::Random(2, S.representationDim());
+  Eigen::MatrixXd Jt(2, S.tangentDim());
+  S.applyDiffRetractation(Jt, J, x);
+  for (size_t i = 0; i < S.numberOfSubManifolds(); ++i)
+  {
+    Eigen::VectorXd zi(S(i).representationDim());
+    Eigen::VectorXd di(S(i).tangentDim());
+    Eigen::MatrixXd Ji(2, S(i).tangentDim());
+    S(i).retractation(zi, S.getView<R>(x, i), S.getView<T>(v, i));
+    BOOST_CHECK(zi.isApprox(S.getView<R>(z, i)));
+    S(i).pseudoLog(di, S.getView<R>(x, i), S.getView<R>(y, i));
+    BOOST_CHECK(di.isApprox(S.getView<T>(d, i)));
+    S(i).applyDiffRetractation(Ji, S.getView<F, R>(J, i), S.getView<R>(x, i));
+    BOOST_CHECK(Ji.isApprox(S.getView<F, T>(Jt, i)));
+  }
+
+  // pseudoLog0 on a product without S2
+  CartesianProduct Q{&R2, &so3Q, &so3Q, &R3, &R2, &so3M, &so3M};
+  Eigen::VectorXd xQ(Q.representationDim());
+  Eigen::VectorXd dQ(Q.tangentDim());
+  Q.createRandomPoint(xQ);
+  Q.pseudoLog0(dQ, xQ);
+  for (size_t i = 0; i < Q.numberOfSubManifolds(); ++i)
+  {
+    Eigen::VectorXd di(Q(i).tangentDim());
+    Q(i).pseudoLog0(di, Q.getView<R>(xQ, i));
+    BOOST_CHECK(di.isApprox(Q.getView<T>(dQ, i)));
+  }
+}
+
+/// \brief RealSpace with a different retractation, x + 2v. It shares the
+/// type id of RealSpace but must not be merged with it.
+class Twice : public RealSpace
+{
+ public:
+  explicit Twice(Index n) : RealSpace(n) {}
+
+ protected:
+  virtual void retractation_(RefVec out, const ConstRefVec& x,
+                             const ConstRefVec& v) const
+  {
+    out = x + 2 * v;
+  }
+  virtual void retractationBatch_(RefMat out, const ConstRefMat& X,
+                                  const ConstRefMat& V) const
+  {
+    out = X + 2 * V;
+  }
+  virtual std::shared_ptr<Manifold> getNewCopy_() const
+  {
+    std::shared_ptr<Twice> copy(new Twice(*this));
+    return copy;
+  }
+};
+
+BOOST_AUTO_TEST_CASE(CardProdDerivedLeavesNotMerged)
+{
+  RealSpace R3(3);
+  Twice T3(3);
+  Twice T2(2);
+  CartesianProduct S{&R3, &T3, &T3, &T2, &R3};
+  Eigen::VectorXd x = Eigen::VectorXd::Random(S.representationDim());
+  Eigen::VectorXd v = Eigen::VectorXd::Random(S.tangentDim());
+  Eigen::VectorXd z(S.representationDim());
+  S.retractation(z, x, v);
+  Eigen::VectorXd expected(S.representationDim());
+  expected << x.head(3) + v.head(3), x.segment(3, 8) + 2 * v.segment(3, 8),
+      x.tail(3) + v.tail(3);
+  BOOST_CHECK(z.isApprox(expected));
+}
+
+/// \brief R3 whose pseudoLog0 throws, to check that the exceptions raised in
+/// a parallel chunk are forwarded
+class ThrowingSpace : public RealSpace
+{
+ public:
+  ThrowingSpace() : RealSpace(3) {}
+
+ protected:
+  virtual void pseudoLog0_(RefVec, const ConstRefVec&) const
+  {
+    throw std::runtime_error("ThrowingSpace::pseudoLog0_");
+  }
+  virtual void pseudoLog0Batch_(RefMat, const ConstRefMat&) const
+  {
+    throw std::runtime_error("ThrowingSpace::pseudoLog0Batch_");
+  }
+  virtual std::shared_ptr<Manifold> getNewCopy_() const
+  {
+    std::shared_ptr<ThrowingSpace> copy(new ThrowingSpace(*this));
+    return copy;
+  }
+};
+
+BOOST_AUTO_TEST_CASE(CardProdParallel)
+{
+  // With a grain, the operations are split in chunks that are processed
+  // concurrently when OpenMP is available. The results must not change.
+  RealSpace R3(3);
+  S2 s2;
+  SO3<ExpMapQuaternion> so3;
+  CartesianProduct P;
+  CartesianProduct S;
+  for (int i = 0; i < 200; ++i)
+  {
+    P.multiply(so3);
+    P.multiply(R3);
+    S.multiply(so3);
+    S.multiply(R3);
+  }
+  for (int i = 0; i < 300; ++i)
+  {
+    P.multiply(so3);
+    S.multiply(so3);
+  }
+  ThrowingSpace T;
+  P.multiply(s2).multiply(T);
+  S.multiply(s2).multiply(T);
+  P.setParallelGrain(64);
+  BOOST_CHECK_EQUAL(P.parallelGrain(), 64);
+  BOOST_CHECK_EQUAL(S.parallelGrain(), 0);
+
+  Eigen::VectorXd x(S.representationDim());
+  Eigen::VectorXd y(S.representationDim());
+  Eigen::VectorXd v(S.tangentDim());
+  S.createRandomPoint(x);
+  S.createRandomPoint(y);
+  S.forceOnTxM(v, Eigen::VectorXd::Random(S.tangentDim()), x);
+  Eigen::VectorXd zP(S.representationDim());
+  Eigen::VectorXd zS(S.representationDim());
+  Eigen::VectorXd dP(S.tangentDim());
+  Eigen::VectorXd dS(S.tangentDim());
+
+  P.retractation(zP, x, v);
+  S.retractation(zS, x, v);
+  BOOST_CHECK(zP.isApprox(zS));
+  P.pseudoLog(dP, x, y);
+  S.pseudoLog(dS, x, y);
+  BOOST_CHECK(dP.isApprox(dS));
+  P.forceOnM(zP, x + 0.1 * y);
+  S.forceOnM(zS, x + 0.1 * y);
+  BOOST_CHECK(zP.isApprox(zS));
+  P.forceOnTxM(dP, dS, x);
+  S.forceOnTxM(dS, dS, x);
+  BOOST_CHECK(dP.isApprox(dS));
+  Eigen::MatrixXd M = Eigen::MatrixXd::Random(S.tangentDim(), 3);
+  Eigen::MatrixXd MP(S.tangentDim(), 3);
+  Eigen::MatrixXd MS(S.tangentDim(), 3);
+  P.applyTransport(MP, M, x, v);
+  S.applyTransport(MS, M, x, v);
+  BOOST_CHECK(MP.isApprox(MS));
+  Eigen::MatrixXd J = Eigen::MatrixXd::Random(3, S.representationDim());
+  Eigen::MatrixXd JP(3, S.tangentDim());
+  Eigen::MatrixXd JS(3, S.tangentDim());
+  P.applyDiffRetractation(JP, J, x);
+  S.applyDiffRetractation(JS, J, x);
+  BOOST_CHECK(JP.isApprox(JS));
+
+  // Exceptions raised in a chunk are forwarded to the caller
+  BOOST_CHECK_THROW(P.pseudoLog0(dP, x), std::runtime_error);
+
+  // A small product keeps the serial path
+  CartesianProduct Q(R3, so3);
+  Q.setParallelGrain(64);
+  Eigen::VectorXd xQ(Q.representationDim());
+  Eigen::VectorXd zQ(Q.representationDim());
+  Q.createRandomPoint(xQ);
+  Q.retractation(zQ, xQ, Eigen::VectorXd::Zero(Q.tangentDim()));
+  BOOST_CHECK(zQ.isApprox(xQ));
+}
+
+BOOST_AUTO_TEST_CASE(CartPowerParallel)
+{
+  // With a grain, the factors of a power are split in ranges that are
+  // processed concurrently. The results must match the serial ones.
+  SO3<ExpMapQuaternion> so3;
+  CartesianPower P(so3, 500);
+  CartesianPower S(so3, 500);
+  P.setParallelGrain(64);
+  BOOST_CHECK_EQUAL(P.parallelGrain(), 64);
+
+  Index t = S.tangentDim();
+  Index r = S.representationDim();
+  Eigen::VectorXd x(r), y(r), v(t), zP(r), zS(r), dP(t), dS(t);
+  S.createRandomPoint(x);
+  S.createRandomPoint(y);
+  S.forceOnTxM(v, Eigen::VectorXd::Random(t), x);
+  P.retractation(zP, x, v);
+  S.retractation(zS, x, v);
+  BOOST_CHECK(zP.isApprox(zS));
+  P.pseudoLog(dP, x, y);
+  S.pseudoLog(dS, x, y);
+  BOOST_CHECK(dP.isApprox(dS));
+  P.pseudoLog0(dP, x);
+  S.pseudoLog0(dS, x);
+  BOOST_CHECK(dP.isApprox(dS));
+  P.forceOnM(zP, x + 0.1 * y);
+  S.forceOnM(zS, x + 0.1 * y);
+  BOOST_CHECK(zP.isApprox(zS));
+  P.forceOnTxM(dP, dS, x);
+  S.forceOnTxM(dS, dS, x);
+  BOOST_CHECK(dP.isApprox(dS));
+  Eigen::MatrixXd H = Eigen::MatrixXd::Random(t, 3);
+  Eigen::MatrixXd HP(t, 3), HS(t, 3);
+  P.applyTransport(HP, H, x, v);
+  S.applyTransport(HS, H, x, v);
+  BOOST_CHECK(HP.isApprox(HS));
+  P.applyInvTransport(HP, H, x, v);
+  S.applyInvTransport(HS, H, x, v);
+  BOOST_CHECK(HP.isApprox(HS));
+  Eigen::MatrixXd J = Eigen::MatrixXd::Random(3, r);
+  Eigen::MatrixXd JP(3, t), JS(3, t);
+  P.applyDiffRetractation(JP, J, x);
+  S.applyDiffRetractation(JS, J, x);
+  BOOST_CHECK(JP.isApprox(JS));
+
+  // Exceptions raised in a range are forwarded to the caller
+  ThrowingSpace T;
+  CartesianPower TP(T, 100);
+  TP.setParallelGrain(32);
+  Eigen::VectorXd xT = Eigen::VectorXd::Zero(TP.representationDim());
+  Eigen::VectorXd dT(TP.tangentDim());
+  BOOST_CHECK_THROW(TP.pseudoLog0(dT, xT), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(CartPowerOperations)
+{
+  // A power shares a single submanifold, it must behave like the product of n
+  // copies
+  const int n = 5;
+  RealSpace R2(2);
+  SO3<ExpMapQuaternion> so3;
+  CartesianProduct M(so3, R2);
+  CartesianPower P(M, n);
+  CartesianProduct S;
+  for (int i = 0; i < n; ++i) S.multiply(M);
+
+  BOOST_CHECK(P.isLocked());
+  BOOST_CHECK_EXCEPTION(P.multiply(R2), std::runtime_error,
+                        [](const std::runtime_error& e)
+                        {
+                          return std::string(e.what()).find(
+                                     "CartesianPower") != std::string::npos;
+                        });
+  BOOST_CHECK_EQUAL(P.numberOfSubManifolds(), n);
+  BOOST_CHECK(P.isSameTopology(S));
+  BOOST_CHECK(S.isSameTopology(P));
+  BOOST_CHECK_EQUAL(P.representationDim(), S.representationDim());
+  BOOST_CHECK_EQUAL(P.tangentDim(), S.tangentDim());
+  BOOST_CHECK(P.name() == S.name());
+
+  Eigen::VectorXd x(P.representationDim());
+  Eigen::VectorXd y(P.representationDim());
+  Eigen::VectorXd v(P.tangentDim());
+  Eigen::VectorXd zP(P.representationDim());
+  Eigen::VectorXd zS(P.representationDim());
+  Eigen::VectorXd dP(P.tangentDim());
+  Eigen::VectorXd dS(P.tangentDim());
+  P.createRandomPoint(x);
+  P.createRandomPoint(y);
+  v.setRandom();
+  for (size_t i = 0; i < static_cast<size_t>(n); ++i)
+  {
+    BOOST_CHECK(&P(i) == &P(0));
+    BOOST_CHECK(P.getView<R>(x, i).data() == S.getView<R>(x, i).data());
+    BOOST_CHECK(P.getView<T>(v, i).data() == S.getView<T>(v, i).data());
+  }
+  BOOST_CHECK(P.isInM(x));
+
+  P.retractation(zP, x, v);
+  S.retractation(zS, x, v);
+  BOOST_CHECK(zP.isApprox(zS));
+  P.pseudoLog(dP, x, y);
+  S.pseudoLog(dS, x, y);
+  BOOST_CHECK(dP.isApprox(dS));
+  P.pseudoLog0(dP, x);
+  S.pseudoLog0(dS, x);
+  BOOST_CHECK(dP.isApprox(dS));
+  P.setZero(zP);
+  S.setZero(zS);
+  BOOST_CHECK(zP.isApprox(zS));
+
+  BOOST_CHECK(P.diffRetractation(x).isApprox(S.diffRetractation(x)));
+  BOOST_CHECK(P.diffPseudoLog0(x).isApprox(S.diffPseudoLog0(x)));
+  Eigen::MatrixXd JR = Eigen::MatrixXd::Random(3, P.representationDim());
+  Eigen::MatrixXd JT = Eigen::MatrixXd::Random(3, P.tangentDim());
+  Eigen::MatrixXd outP(3, P.tangentDim());
+  Eigen::MatrixXd outS(3, P.tangentDim());
+  P.applyDiffRetractation(outP, JR, x);
+  S.applyDiffRetractation(outS, JR, x);
+  BOOST_CHECK(outP.isApprox(outS));
+  P.applyInvTransportOnTheRight(outP, JT, x, v);
+  S.applyInvTransportOnTheRight(outS, JT, x, v);
+  BOOST_CHECK(outP.isApprox(outS));
+  Eigen::MatrixXd outRP(3, P.representationDim());
+  Eigen::MatrixXd outRS(3, P.representationDim());
+  P.applyDiffPseudoLog0(outRP, JT, x);
+  S.applyDiffPseudoLog0(outRS, JT, x);
+  BOOST_CHECK(outRP.isApprox(outRS));
+  Eigen::MatrixXd M0 = Eigen::MatrixXd::Random(P.tangentDim(), 3);
+  Eigen::MatrixXd MP(P.tangentDim(), 3);
+  Eigen::MatrixXd MS(P.tangentDim(), 3);
+  P.applyTransport(MP, M0, x, v);
+  S.applyTransport(MS, M0, x, v);
+  BOOST_CHECK(MP.isApprox(MS));
+  P.applyInvTransport(MP, M0, x, v);
+  S.applyInvTransport(MS, M0, x, v);
+  BOOST_CHECK(MP.isApprox(MS));
+
+  BOOST_CHECK(P.getTypicalMagnitude().isApprox(S.getTypicalMagnitude()));
+  Eigen::VectorXd lP(P.tangentDim());
+  Eigen::VectorXd lS(P.tangentDim());
+  P.limitMap(lP);
+  S.limitMap(lS);
+  BOOST_CHECK(lP == lS);
+  Eigen::MatrixXd IP(P.tangentDim(), P.tangentDim());
+  Eigen::MatrixXd IS(P.tangentDim(), P.tangentDim());
+  P.getIdentityOnTxM(IP, x);
+  S.getIdentityOnTxM(IS, x);
+  BOOST_CHECK(IP.isApprox(IS));
+
+  // The power is a single leaf of an enclosing product
+  CartesianProduct Q(P, R2);
+  Eigen::VectorXd xQ(Q.representationDim());
+  Eigen::VectorXd zQ(Q.representationDim());
+  Eigen::VectorXd vQ = Eigen::VectorXd::Random(Q.tangentDim());
+  Q.createRandomPoint(xQ);
+  Q.retractation(zQ, xQ, vQ);
+  S.retractation(zS, xQ.head(S.representationDim()),
+                 vQ.head(S.tangentDim()));
+  BOOST_CHECK(zS.isApprox(zQ.head(S.representationDim())));
+}
+
+BOOST_AUTO_TEST_CASE(CardProdRetractationWithJacobian)
+{
+  RealSpace R3(3);
+  S2 s2;
+  SO3<ExpMapQuaternion> so3Q;
+  SO3<ExpMapMatrix> so3M;
+  SO3<CayleyMapQuaternion> cayQ;
+  SO3<CayleyMapMatrix> cayM;
+  CartesianProduct M(R3, s2);
+  M.multiply(so3Q).multiply(so3M).multiply(cayQ).multiply(cayM);
+  CartesianPower Pw(so3M, 3);
+  M.multiply(Pw);
+  // two identical leaves, handled as a run
+  M.multiply(so3Q).multiply(so3Q);
+
+  Index t = M.tangentDim();
+  Index r = M.representationDim();
+  Eigen::VectorXd x(r), v(t), d(t), z(r), zp(r), zm(r), zJ(r);
+  Eigen::MatrixXd J(r, t);
+  const double h = 1e-6;
+  for (int i = 0; i < 10; ++i)
+  {
+    M.createRandomPoint(x);
+    M.forceOnTxM(v, Eigen::VectorXd::Random(t), x);
+    if (i == 0) v *= 1e-5;  // small angles
+    M.retractation(z, x, v);
+    M.retractationWithJacobian(zJ, J, x, v);
+    BOOST_CHECK(zJ.isApprox(z));
+
+    // directional derivatives, by central finite differences
+    for (int k = 0; k < 3; ++k)
+    {
+      M.forceOnTxM(d, Eigen::VectorXd::Random(t), x);
+      M.retractation(zp, x, v + h * d);
+      M.retractation(zm, x, v - h * d);
+      BOOST_CHECK_SMALL(((zp - zm) / (2 * h) - J * d).lpNorm<Eigen::Infinity>(),
+                        1e-8);
+    }
+  }
+
+  // in place
+  M.retractationWithJacobian(x, J, x, v);
+  BOOST_CHECK(x.isApprox(z));
+}
+
+BOOST_AUTO_TEST_CASE(CardProdPseudoLogWithJacobian)
+{
+  RealSpace R3(3);
+  S2 s2;
+  SO3<ExpMapQuaternion> so3Q;
+  SO3<ExpMapMatrix> so3M;
+  SO3<CayleyMapQuaternion> cayQ;
+  SO3<CayleyMapMatrix> cayM;
+  CartesianProduct M(R3, s2);
+  M.multiply(so3Q).multiply(so3M).multiply(cayQ).multiply(cayM);
+  CartesianPower Pw(so3M, 3);
+  M.multiply(Pw);
+  M.multiply(so3Q).multiply(so3Q);
+
+  Index t = M.tangentDim();
+  Index r = M.representationDim();
+  Eigen::VectorXd x(r), y(r), xp(r), xm(r), w(t), z(t), v(t), vJ(t), vp(t),
+      vm(t);
+  Eigen::MatrixXd Jx(t, r), Jy(t, r), Rx(r, t), Ry(r, t);
+  const double h = 1e-6;
+  // The Jacobians are only meaningful along the manifold: the different
+  // implementations of pseudoLog agree on M but not outside of it, so that we
+  // take the finite differences along curves retract(x, s*w).
+  z.setZero();
+  for (int i = 0; i < 10; ++i)
+  {
+    M.createRandomPoint(x);
+    M.createRandomPoint(y);
+    M.pseudoLog(v, x, y);
+    M.pseudoLogWithJacobian(vJ, Jx, Jy, x, y);
+    BOOST_CHECK(vJ.isApprox(v));
+    M.retractationWithJacobian(xp, Rx, x, z);
+    M.retractationWithJacobian(xp, Ry, y, z);
+
+    for (int k = 0; k < 3; ++k)
+    {
+      M.forceOnTxM(w, Eigen::VectorXd::Random(t), x);
+      M.retractation(xp, x, h * w);
+      M.retractation(xm, x, -h * w);
+      M.pseudoLog(vp, xp, y);
+      M.pseudoLog(vm, xm, y);
+      BOOST_CHECK_SMALL(
+          ((vp - vm) / (2 * h) - Jx * Rx * w).lpNorm<Eigen::Infinity>(), 1e-7);
+      M.forceOnTxM(w, Eigen::VectorXd::Random(t), y);
+      M.retractation(xp, y, h * w);
+      M.retractation(xm, y, -h * w);
+      M.pseudoLog(vp, x, xp);
+      M.pseudoLog(vm, x, xm);
+      BOOST_CHECK_SMALL(
+          ((vp - vm) / (2 * h) - Jy * Ry * w).lpNorm<Eigen::Infinity>(), 1e-7);
+    }
+  }
+
+  // y close to x, with a larger step to reduce the cancellation errors of
+  // the acos of the logarithms
+  const double hc = 1e-5;
+  M.forceOnTxM(v, 1e-4 * Eigen::VectorXd::Random(t), x);
+  M.retractation(y, x, v);
+  M.pseudoLogWithJacobian(vJ, Jx, Jy, x, y);
+  BOOST_CHECK_SMALL((vJ - v).lpNorm<Eigen::Infinity>(), 1e-10);
+  M.retractationWithJacobian(xp, Ry, y, z);
+  M.forceOnTxM(w, Eigen::VectorXd::Random(t), y);
+  M.retractation(xp, y, hc * w);
+  M.retractation(xm, y, -hc * w);
+  M.pseudoLog(vp, x, xp);
+  M.pseudoLog(vm, x, xm);
+  BOOST_CHECK_SMALL(
+      ((vp - vm) / (2 * hc) - Jy * Ry * w).lpNorm<Eigen::Infinity>(), 1e-6);
+}
+
 #if EIGEN_WORLD_VERSION > 3 ||                               \
     (EIGEN_WORLD_VERSION == 3 && EIGEN_MAJOR_VERSION > 2) || \
     (EIGEN_WORLD_VERSION == 3 && EIGEN_MAJOR_VERSION == 2 && \
@@ -603,6 +1372,9 @@ BOOST_AUTO_TEST_CASE(CardProdNoAllocation)
   Eigen::MatrixXd H0 = Eigen::MatrixXd::Random(S.dim(), S.dim());
   Eigen::MatrixXd H1 = Eigen::MatrixXd::Random(S.dim(), S.dim());
   Eigen::MatrixXd H2 = Eigen::MatrixXd::Random(S.dim(), S.dim());
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(repDim, r);
+  Eigen::MatrixXd P = Eigen::MatrixXd::Random(dim, r);
+  Eigen::MatrixXd Z(repDim, r);
 
   // The first call to the following methods might trigger a memory allocation
   // depending on the size of the Ji and the initial buffer size inside S.
@@ -615,7 +1387,10 @@ BOOST_AUTO_TEST_CASE(CardProdNoAllocation)
   utils::set_is_malloc_allowed(false);
   {
     S.retractation(z, x, p);
+    S.retractationBatch(Z, X, P);
     S.pseudoLog(d, y, x);
+    S.pseudoLogBatch(P, X, X);
+    S.pseudoLog0Batch(P, X);
     S.pseudoLog0(d, x);
     S.applyDiffRetractation(J1, J0, x);
     S.applyDiffPseudoLog0(J2, J1, x);
@@ -65,7 +65,30 @@ Point createR3Point()
   return R3.createPoint();
 }
 
+#ifndef MNF_NO_REF_COUNTER
 BOOST_AUTO_TEST_CASE(ManifoldRefCounter)
 {
   CHECK_THROW_IN_DEBUG(createR3Point(), mnf::mnf_exception);
 }
+#endif
+
+#if defined(_OPENMP) && defined(MNF_ATOMIC_REF_COUNTER)
+BOOST_AUTO_TEST_CASE(ManifoldRefCounterThreads)
+{
+  // Points of shared manifolds are created and destroyed by several threads.
+  // With a non atomic counter, some updates would be lost and the manifolds
+  // could not be destroyed.
+  RealSpace* R3 = new RealSpace(3);
+  CartesianProduct* P = new CartesianProduct(*R3, *R3);
+#pragma omp parallel for
+  for (int i = 0; i < 10000; ++i)
+  {
+    Point x = R3->getZero();
+    Point y = P->getZero();
+    SubPoint y0 = y(0);
+    y0.value() = x.value();
+  }
+  CHECK_NO_THROW_IN_DEBUG(delete P, mnf::mnf_exception);
+  CHECK_NO_THROW_IN_DEBUG(delete R3, mnf::mnf_exception);
+}
+#endif
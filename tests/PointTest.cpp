@@ -16,6 +16,8 @@
 // <http://www.gnu.org/licenses/>.
 
 #include <iostream>
+#include <type_traits>
+#include <vector>
 
 #ifndef _WIN32
 #define BOOST_TEST_MODULE Manifold
@@ -26,7 +28,10 @@
 #include <manifolds/defs.h>
 #include <manifolds/utils.h>
 #include <manifolds/Point.h>
+#include <manifolds/PointArena.h>
+#include <manifolds/PointView.h>
 #include <manifolds/RealSpace.h>
+#include <manifolds/S2.h>
 #include <manifolds/SO3.h>
 #include <manifolds/ExpMapMatrix.h>
 #include <manifolds/CartesianProduct.h>
@@ -135,6 +140,71 @@ BOOST_AUTO_TEST_CASE(PointMinus)
   BOOST_CHECK(res.isApprox(v));
 }
 
+BOOST_AUTO_TEST_CASE(PointExpressions)
+{
+  SO3<ExpMapMatrix> S;
+  RealSpace R3(3);
+  CartesianProduct P(S, R3);
+  Point x = P.createRandomPoint();
+  Eigen::VectorXd v1 = Eigen::VectorXd::Random(6);
+  Eigen::VectorXd v2 = Eigen::VectorXd::Random(6);
+  double a = 0.3, b = -0.7;
+
+  Point y = x + v1;
+  BOOST_CHECK(y.value().isApprox(x.retractation(v1).value()));
+
+  Eigen::VectorXd v = a * v1 + b * v2;
+  Point z = P.createPoint();
+  z = x + (a * v1 + b * v2);
+  BOOST_CHECK(z.value().isApprox(x.retractation(v).value()));
+  z = x + v1 + v2;
+  BOOST_CHECK(z.value().isApprox(y.retractation(v2).value()));
+  z = x;
+  z = z + v1.head(6);
+  BOOST_CHECK(z.value().isApprox(y.value()));
+
+  Eigen::VectorXd d = y - x;
+  BOOST_CHECK(d.isApprox(v1));
+  Eigen::VectorXd d2(6);
+  d2 = z - x;
+  BOOST_CHECK(d2.isApprox(v1));
+  BOOST_CHECK_CLOSE((y - x).norm(), v1.norm(), 1e-8);
+
+  // Stored expressions: the temporary a*v1 + b*v2 is copied in the sum
+  auto e = x + (a * v1 + b * v2);
+  Point w = e;
+  BOOST_CHECK(w.value().isApprox(x.retractation(v).value()));
+  BOOST_CHECK(e.eval().value().isApprox(w.value()));
+  BOOST_CHECK((x + v1).eval().value().isApprox(y.value()));
+  auto f = y - x;
+  Eigen::VectorXd fv = f.eval();
+  BOOST_CHECK(fv.isApprox(v1));
+
+  // The tangent space of S2 is larger than its dimension
+  S2 S2;
+  Point s = S2.createRandomPoint();
+  Point t = S2.createRandomPoint();
+  Eigen::VectorXd st = t - s;
+  BOOST_CHECK_EQUAL(st.size(), 3);
+  BOOST_CHECK(st.isApprox(s.pseudoLog(t)));
+
+  // Line search like loop
+  z = x + (a * v1 + b * v2);
+  Eigen::internal::set_is_malloc_allowed(false);
+  utils::set_is_malloc_allowed(false);
+  {
+    for (int i = 0; i < 10; ++i)
+    {
+      double alpha = 1. / (i + 1);
+      z = x + (alpha * v1 + b * v2);
+      d2 = z - x;
+      z = z + d2;
+    }
+  }
+  utils::set_is_malloc_allowed(true);
+  Eigen::internal::set_is_malloc_allowed(true);
+}
+
 BOOST_AUTO_TEST_CASE(SubPointManipulation)
 {
   RealSpace R2(2);
@@ -265,6 +335,176 @@ BOOST_AUTO_TEST_CASE(SO3ApplyInvDiff)
   BOOST_CHECK(expectedRes.isApprox(J));
 }
 
+BOOST_AUTO_TEST_CASE(PointMove)
+{
+  RealSpace R3(3);
+  Point x = R3.createPoint(Eigen::Vector3d(1, 2, 3));
+  const double* data = x.value().data();
+
+  Point y(std::move(x));
+  BOOST_CHECK(y.value().data() == data);
+  BOOST_CHECK(y.value().isApprox(Eigen::Vector3d(1, 2, 3)));
+  BOOST_CHECK_EQUAL(x.value().size(), 0);
+
+  Point z = R3.getZero();
+  const double* zData = z.value().data();
+  z = std::move(y);
+  BOOST_CHECK(z.value().data() == data);
+  BOOST_CHECK(y.value().data() == zData);
+  BOOST_CHECK(y.value().isZero());
+
+  // A moved from point can be assigned by move
+  x = std::move(y);
+  BOOST_CHECK(x.value().data() == zData);
+
+  // Moving from an empty point gives an empty point
+  BOOST_CHECK_EQUAL(y.value().size(), 0);
+  Point u(std::move(y));
+  BOOST_CHECK_EQUAL(u.value().size(), 0);
+  BOOST_CHECK_EQUAL(y.value().size(), 0);
+
+#ifndef NDEBUG
+  // Asserts with exception throwing are performed only in debug
+  RealSpace R2(2);
+  Point w = R2.createPoint();
+  BOOST_CHECK_THROW(w = std::move(x), mnf_exception);
+  BOOST_CHECK_THROW(z = std::move(u), mnf_exception);
+  BOOST_CHECK(z.value().data() == data);
+#endif
+
+  // The growth of a vector moves the points instead of copying them
+  std::vector<Point> points;
+  std::vector<const double*> buffers;
+  for (int i = 0; i < 20; ++i)
+  {
+    points.push_back(R3.createPoint(Eigen::Vector3d::Constant(i)));
+    buffers.push_back(points.back().value().data());
+  }
+  for (size_t i = 0; i < points.size(); ++i)
+  {
+    BOOST_CHECK(points[i].value().data() == buffers[i]);
+    BOOST_CHECK(points[i].value().isApprox(
+        Eigen::Vector3d::Constant(static_cast<double>(i))));
+  }
+  points.erase(points.begin());
+  BOOST_CHECK(points[0].value().data() == buffers[1]);
+}
+
+BOOST_AUTO_TEST_CASE(PointViews)
+{
+  BOOST_CHECK(std::is_trivially_copyable<ConstPointView>::value);
+  BOOST_CHECK(std::is_trivially_copyable<PointView>::value);
+
+  RealSpace R3(3);
+  SO3<ExpMapMatrix> S;
+  CartesianProduct R3S(R3, S);
+  CartesianProduct P(R3S, R3);
+  Point x = P.createRandomPoint();
+
+  ConstPointView cv = x.view();
+  BOOST_CHECK(&cv.getManifold() == &P);
+  BOOST_CHECK(cv.value().data() == x.value().data());
+  BOOST_CHECK_EQUAL(cv.value().size(), P.representationDim());
+  BOOST_CHECK(cv[0].isApprox(x[0]));
+  BOOST_CHECK(cv[1].isApprox(x[1]));
+  BOOST_CHECK(cv(0)[1].isApprox(x(0)[1]));
+  BOOST_CHECK(&cv(0)(1).getManifold() == &x(0)(1).getManifold());
+
+  // Walking and writing through views does not allocate
+  Eigen::internal::set_is_malloc_allowed(false);
+  utils::set_is_malloc_allowed(false);
+  {
+    PointView v = x.view();
+    v(0)[0].setConstant(4);
+    v[1] = v(0)[0];
+    ConstPointView c = v(0)(1);
+    v(0)(1).value() = c.value();
+  }
+  utils::set_is_malloc_allowed(true);
+  Eigen::internal::set_is_malloc_allowed(true);
+  BOOST_CHECK(x(0)[0].isApprox(Eigen::Vector3d::Constant(4)));
+  BOOST_CHECK(x[1].isApprox(Eigen::Vector3d::Constant(4)));
+
+  SubPoint sub = x(0);
+  BOOST_CHECK(sub.view().data() == sub.value().data());
+  Point y(x.view()(0));
+  BOOST_CHECK(&y.getManifold() == &x(0).getManifold());
+  BOOST_CHECK(y.value().isApprox(x[0]));
+  BOOST_CHECK(y.value().data() != x[0].data());
+}
+
+BOOST_AUTO_TEST_CASE(PointArenaRecycling)
+{
+  PointArena arena(64);
+  double* a = arena.allocate(3);
+  double* b = arena.allocate(4);  // same size class as a
+  double* c = arena.allocate(9);
+  BOOST_CHECK_EQUAL(arena.liveBlocks(), 3);
+  BOOST_CHECK_EQUAL(arena.numberOfSlabs(), 1);
+  arena.deallocate(a, 3);
+  BOOST_CHECK(arena.allocate(4) == a);
+  arena.deallocate(c, 9);
+  BOOST_CHECK(arena.allocate(12) == c);
+  double* big = arena.allocate(100);  // larger than a slab
+  BOOST_CHECK_EQUAL(arena.numberOfSlabs(), 2);
+  arena.deallocate(a, 4);
+  arena.deallocate(b, 4);
+  arena.deallocate(c, 12);
+  arena.deallocate(big, 100);
+  BOOST_CHECK_EQUAL(arena.liveBlocks(), 0);
+
+  // After a reset, the memory is given again from the start of the slabs
+  arena.reset();
+  BOOST_CHECK(arena.allocate(3) == a);
+  BOOST_CHECK_EQUAL(arena.numberOfSlabs(), 2);
+  arena.deallocate(a, 3);
+}
+
+BOOST_AUTO_TEST_CASE(PointArenaStorage)
+{
+  PointArena arena;
+  RealSpace R3(3);
+  SO3<ExpMapMatrix> S;
+  CartesianProduct P(R3, S);
+  P.setPointArena(&arena);
+  BOOST_CHECK(P.pointArena() == &arena);
+  BOOST_CHECK(R3.pointArena() == 0x0);
+  {
+    Point x = P.getZero();
+    Point y = P.createRandomPoint();
+    Eigen::VectorXd v = Eigen::VectorXd::Random(P.tangentDim());
+    Point z = y.retractation(v);
+    Point w = y + v;
+    Point c(z);
+    BOOST_CHECK_EQUAL(arena.liveBlocks(), 5);
+    BOOST_CHECK(z.value().isApprox(w.value()));
+    BOOST_CHECK(c.value().isApprox(z.value()));
+    Eigen::VectorXd expected(P.representationDim());
+    P.retractation(expected, y.value(), v);
+    BOOST_CHECK(z.value().isApprox(expected));
+
+    // Points created from subpoints belong to the submanifold copies, which
+    // do not share the arena
+    Point r = x(0);
+    BOOST_CHECK_EQUAL(arena.liveBlocks(), 5);
+    BOOST_CHECK(r.value().isApprox(Eigen::Vector3d::Zero()));
+  }
+  BOOST_CHECK_EQUAL(arena.liveBlocks(), 0);
+  arena.reset();
+
+  // Once the slabs are allocated, creating points does not allocate memory
+  Point x = P.getZero();
+  Eigen::VectorXd v = Eigen::VectorXd::Random(P.tangentDim());
+  Eigen::internal::set_is_malloc_allowed(false);
+  utils::set_is_malloc_allowed(false);
+  {
+    Point y = x.retractation(v);
+    Point z(y);
+  }
+  utils::set_is_malloc_allowed(true);
+  Eigen::internal::set_is_malloc_allowed(true);
+}
+
 #if EIGEN_WORLD_VERSION > 3 ||                               \
     (EIGEN_WORLD_VERSION == 3 && EIGEN_MAJOR_VERSION > 2) || \
     (EIGEN_WORLD_VERSION == 3 && EIGEN_MAJOR_VERSION == 2 && \
@@ -295,6 +535,9 @@ BOOST_AUTO_TEST_CASE(PointNoAllocation)
     std::cout << "- method 'pseudoLog' passed" << std::endl;
     x.pseudoLog0(v);
     std::cout << "- method 'pseudoLog0' passed" << std::endl;
+    Point z(std::move(x));
+    z = std::move(y);
+    std::cout << "- move of a Point passed" << std::endl;
   }
   utils::set_is_malloc_allowed(true);
   Eigen::internal::set_is_malloc_allowed(true);
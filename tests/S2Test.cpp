@@ -209,6 +209,104 @@ BOOST_AUTO_TEST_CASE(S2InvTransport)
   }
 }
 
+BOOST_AUTO_TEST_CASE(S2TransportHandle)
+{
+  int c = 5;
+  S2 Space;
+  MatrixXd H = MatrixXd::Random(3, c);
+  MatrixXd Hr = MatrixXd::Random(c, 3);
+  MatrixXd Hout(3, c), Hexp(3, c), Hrout(c, 3), Hrexp(c, 3);
+  Point x = Space.createRandomPoint();
+  VectorXd v = Space.randVec(x.value());
+  S2::Transport T = Space.transport(x.value(), v);
+
+  Eigen::Vector3d y;
+  Space.retractation(y, x.value(), v);
+  BOOST_CHECK(T.target().isApprox(y));
+  BOOST_CHECK(T.rotation().isUnitary());
+  BOOST_CHECK(y.isApprox(T.rotation() * x.value()));
+
+  Space.applyTransport(Hexp, H, x.value(), v);
+  T.applyTransport(Hout, H);
+  BOOST_CHECK(Hout.isApprox(Hexp));
+  Space.applyInvTransport(Hexp, H, x.value(), v);
+  T.applyInvTransport(Hout, H);
+  BOOST_CHECK(Hout.isApprox(Hexp));
+  Space.applyInvTransportOnTheRight(Hrexp, Hr, x.value(), v);
+  T.applyInvTransportOnTheRight(Hrout, Hr);
+  BOOST_CHECK(Hrout.isApprox(Hrexp));
+  BOOST_CHECK(Hrout.isApprox(Hr * T.rotation().transpose()));
+
+  // in place
+  Hexp = T.rotation() * H;
+  T.applyTransport(H, H);
+  BOOST_CHECK(H.isApprox(Hexp));
+}
+
+BOOST_AUTO_TEST_CASE(S2PseudoLog0)
+{
+  S2 Space;
+  Vector3d e, x, v, v0;
+  Space.setZero(e);
+  for (int i = 0; i < 10; ++i)
+  {
+    Space.rand(x);
+    Space.pseudoLog(v, e, x);
+    Space.pseudoLog0(v0, x);
+    BOOST_CHECK(v0.isApprox(v));
+  }
+  Space.pseudoLog0(v0, e);
+  BOOST_CHECK(v0.isZero());
+}
+
+BOOST_AUTO_TEST_CASE(S2DiffRetractation)
+{
+  S2 Space;
+  const double h = 1e-6;
+  Vector3d x, w, yp, ym;
+  MatrixXd J0 = MatrixXd::Random(4, 3);
+  MatrixXd J1(4, 3);
+  for (int i = 0; i < 10; ++i)
+  {
+    Space.rand(x);
+    MatrixXd J = Space.diffRetractation(x);
+    w = Space.randVec(x);
+    Space.retractation(yp, x, h * w);
+    Space.retractation(ym, x, -h * w);
+    BOOST_CHECK_SMALL(((yp - ym) / (2 * h) - J * w).lpNorm<Infinity>(), 1e-8);
+    Space.applyDiffRetractation(J1, J0, x);
+    BOOST_CHECK(J1.isApprox(J0 * J));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(S2DiffPseudoLog0)
+{
+  S2 Space;
+  const double h = 1e-6;
+  Vector3d x, w, xp, xm, vp, vm;
+  MatrixXd J0 = MatrixXd::Random(4, 3);
+  MatrixXd J1(4, 3);
+  for (int i = 0; i < 10; ++i)
+  {
+    Space.rand(x);
+    MatrixXd J = Space.diffPseudoLog0(x);
+    // finite differences along the sphere, where pseudoLog0 is defined
+    w = Space.randVec(x);
+    Space.retractation(xp, x, h * w);
+    Space.retractation(xm, x, -h * w);
+    Space.pseudoLog0(vp, xp);
+    Space.pseudoLog0(vm, xm);
+    BOOST_CHECK_SMALL(((vp - vm) / (2 * h) - J * w).lpNorm<Infinity>(), 1e-8);
+    Space.applyDiffPseudoLog0(J1, J0, x);
+    BOOST_CHECK(J1.isApprox(J0 * J));
+  }
+
+  // at the zero point, the derivative is the projection on its tangent space
+  Space.setZero(x);
+  MatrixXd J = Space.diffPseudoLog0(x);
+  BOOST_CHECK(J.isApprox(Space.diffRetractation(x)));
+}
+
 BOOST_AUTO_TEST_CASE(S2LimitMap)
 {
   S2 Space;
@@ -279,7 +377,9 @@ BOOST_AUTO_TEST_CASE(S2NoAllocation)
   {
     Space.retractation(z, x, vx);
     Space.pseudoLog(z, x, y);
+    Space.pseudoLog0(z, x);
     Space.applyDiffRetractation(J1, J0, x);
+    Space.applyDiffPseudoLog0(J2, J0, x);
     Space.applyTransport(H1, H0, x, vx);
     Space.applyInvTransport(H2, H0, x, vx);
     Space.getIdentityOnTxM(H0, x);
@@ -26,10 +26,12 @@
 #include <manifolds/RealSpace.h>
 #include <manifolds/S2.h>
 #include <manifolds/CartesianProduct.h>
+#include <manifolds/CayleyMapMatrix.h>
 #include <manifolds/SO3.h>
 #include <manifolds/Point.h>
 #include <manifolds/ExpMapMatrix.h>
 #include <manifolds/ExpMapQuaternion.h>
+#include <manifolds/FastTrig.h>
 
 #include <Eigen/Core>
 #include <Eigen/LU>
@@ -52,6 +54,189 @@ BOOST_AUTO_TEST_CASE(RotSpaceConstructor)
   BOOST_CHECK(S.isElementary());
 }
 
+BOOST_AUTO_TEST_CASE(SO3BatchKernels)
+{
+  // 21 columns: two full blocks and a partial one
+  const Index N = 21;
+  SO3<ExpMapMatrix> S;
+  Eigen::MatrixXd V = Eigen::MatrixXd::Random(3, N);
+  V.col(0).setZero();
+  V.col(1) *= 1e-9;
+  V.col(2) = 3.1 * V.col(2).normalized();
+  V.col(3) << 1e-5, 0, 0;
+  V.col(4) = 2 * V.col(4).normalized();  // angle larger than pi/2
+  Eigen::MatrixXd X(9, N), Y(9, N);
+  for (Index j = 0; j < N; ++j)
+  {
+    X.col(j) = S.createRandomPoint().value();
+    Y.col(j) = S.createRandomPoint().value();
+  }
+  Y.col(5) = X.col(5);
+  // rotation of exactly pi, whose antisymmetric part is 0
+  toMat3(X.col(6).data()) = Eigen::Vector3d(1, -1, -1).asDiagonal();
+
+  Eigen::MatrixXd E(9, N), out3(3, N), out9(9, N);
+  ExpMapMatrix::exponentialBatch(E, V);
+  for (Index j = 0; j < N; ++j)
+  {
+    ExpMapMatrix::OutputType Ej;
+    ExpMapMatrix::exponential(Ej, V.col(j));
+    BOOST_CHECK_SMALL(
+        (E.col(j) - Eigen::Map<Eigen::VectorXd>(Ej.data(), 9)).lpNorm<
+            Eigen::Infinity>(),
+        1e-14);
+  }
+  // The scalar logarithm uses acos, that loses precision for small angles:
+  // the batched one is checked against the increments instead
+  ExpMapMatrix::logarithmBatch(out3, E);
+  BOOST_CHECK_SMALL((out3 - V).lpNorm<Eigen::Infinity>(), 1e-12);
+  ExpMapMatrix::logarithmBatch(out3, X);
+  for (Index j = 0; j < N; ++j)
+  {
+    Eigen::Vector3d v;
+    ExpMapMatrix::logarithm(v, toMat3(X.col(j).data()));
+    BOOST_CHECK_SMALL((out3.col(j) - v).lpNorm<Eigen::Infinity>(), 1e-10);
+  }
+
+  S.retractationBatch(out9, X, V);
+  for (Index j = 0; j < N; ++j)
+  {
+    Eigen::VectorXd x(9);
+    S.retractation(x, X.col(j), V.col(j));
+    BOOST_CHECK_SMALL((out9.col(j) - x).lpNorm<Eigen::Infinity>(), 1e-14);
+  }
+  S.pseudoLogBatch(out3, X, out9);
+  BOOST_CHECK_SMALL((out3 - V).lpNorm<Eigen::Infinity>(), 1e-12);
+  S.pseudoLogBatch(out3, X, Y);
+  for (Index j = 0; j < N; ++j)
+  {
+    Eigen::Vector3d v;
+    S.pseudoLog(v, X.col(j), Y.col(j));
+    BOOST_CHECK_SMALL((out3.col(j) - v).lpNorm<Eigen::Infinity>(), 1e-10);
+  }
+  S.pseudoLog0Batch(out3, Y);
+  for (Index j = 0; j < N; ++j)
+  {
+    Eigen::Vector3d v;
+    S.pseudoLog0(v, Y.col(j));
+    BOOST_CHECK_SMALL((out3.col(j) - v).lpNorm<Eigen::Infinity>(), 1e-10);
+  }
+
+  // In place retractation
+  Eigen::MatrixXd Z = X;
+  S.retractationBatch(Z, Z, V);
+  BOOST_CHECK(Z.isApprox(out9));
+}
+
+BOOST_AUTO_TEST_CASE(SO3FastTrig)
+{
+  SO3<ExpMapMatrix> S;
+  SO3<FastTrig<ExpMapMatrix> > F;
+  BOOST_CHECK(S.getTypeId() != F.getTypeId());
+  const double bound = FastTrig<ExpMapMatrix>::errorBound;
+  for (int i = 0; i < 100; ++i)
+  {
+    Eigen::Vector3d v = Eigen::Vector3d::Random();
+    v *= (i % 2 ? 3.14 : 0.5) * std::abs(Eigen::Vector2d::Random()[0]) /
+         v.norm();
+    // the error decreases quickly with the angle
+    double prec = (i % 2 ? bound : 1e-15);
+    Point x = S.createRandomPoint();
+    Eigen::VectorXd z(9), zF(9);
+    S.retractation(z, x.value(), v);
+    F.retractation(zF, x.value(), v);
+    BOOST_CHECK_SMALL((z - zF).lpNorm<Eigen::Infinity>(), prec);
+    // The logarithm of ExpMapMatrix uses acos and is less precise than the
+    // one of FastTrig: both are compared to the increment
+    Eigen::Vector3d w, wF;
+    S.pseudoLog(w, x.value(), z);
+    F.pseudoLog(wF, x.value(), z);
+    BOOST_CHECK_SMALL((v - w).lpNorm<Eigen::Infinity>(), 1e-6);
+    BOOST_CHECK_SMALL((v - wF).lpNorm<Eigen::Infinity>(), 1e-13);
+  }
+  Eigen::Vector3d v(1e-9, -2e-10, 0), w;
+  Eigen::VectorXd z(9);
+  F.retractation(z, F.getZero().value(), v);
+  F.pseudoLog0(w, z);
+  BOOST_CHECK_SMALL((v - w).lpNorm<Eigen::Infinity>(), 1e-22);
+
+  // rotation of exactly pi, whose antisymmetric part is 0
+  toMat3(z.data()) = Eigen::Vector3d(1, -1, -1).asDiagonal();
+  Eigen::Vector3d wS;
+  S.pseudoLog0(wS, z);
+  F.pseudoLog0(w, z);
+  BOOST_CHECK(w.allFinite());
+  BOOST_CHECK_EQUAL(w, wS);
+}
+
+BOOST_AUTO_TEST_CASE(SO3CayleyMap)
+{
+  SO3<ExpMapMatrix> S;
+  SO3<CayleyMapMatrix> C;
+  BOOST_CHECK(S.getTypeId() != C.getTypeId());
+  const Index N = 10;
+  Eigen::MatrixXd X(9, N), Y(9, N), Z(9, N), W(3, N);
+  Eigen::MatrixXd V = Eigen::MatrixXd::Random(3, N);
+  V.col(0) *= 10;  // the Cayley map is defined for any increment
+  for (Index j = 0; j < N; ++j)
+  {
+    X.col(j) = C.createRandomPoint().value();
+    Y.col(j) = C.createRandomPoint().value();
+  }
+
+  C.retractationBatch(Z, X, V);
+  C.pseudoLogBatch(W, X, Z);
+  BOOST_CHECK(W.isApprox(V));
+  for (Index j = 0; j < N; ++j)
+  {
+    Eigen::VectorXd z(9);
+    C.retractation(z, X.col(j), V.col(j));
+    BOOST_CHECK(z.isApprox(Z.col(j)));
+    BOOST_CHECK(C.isInM(z));
+    Eigen::Vector3d w;
+    C.pseudoLog(w, X.col(j), Y.col(j));
+    C.retractation(z, X.col(j), w);
+    BOOST_CHECK(z.isApprox(Y.col(j)));
+  }
+  C.pseudoLog0Batch(W, Y);
+  for (Index j = 0; j < N; ++j)
+  {
+    Eigen::Vector3d w;
+    C.pseudoLog0(w, Y.col(j));
+    BOOST_CHECK(w.isApprox(W.col(j)));
+  }
+
+  // The Cayley map is a second order approximation of the exponential
+  Eigen::Vector3d v = 1e-3 * Eigen::Vector3d::Random();
+  Eigen::VectorXd z(9), zC(9);
+  S.retractation(z, X.col(0), v);
+  C.retractation(zC, X.col(0), v);
+  BOOST_CHECK_SMALL((z - zC).lpNorm<Eigen::Infinity>(), 1e-9);
+
+  // Derivatives, checked by finite differences
+  const double h = 1e-8;
+  Eigen::VectorXd x = Y.col(1);
+  Eigen::MatrixXd Jr(9, 3), Jl(3, 9);
+  Eigen::Vector3d w0, w1;
+  C.pseudoLog0(w0, x);
+  for (Index i = 0; i < 3; ++i)
+  {
+    C.retractation(z, x, h * Eigen::Vector3d::Unit(i));
+    Jr.col(i) = (z - x) / h;
+  }
+  for (Index i = 0; i < 9; ++i)
+  {
+    z = x + h * Eigen::VectorXd::Unit(9, i);
+    C.pseudoLog0(w1, z);
+    Jl.col(i) = (w1 - w0) / h;
+  }
+  BOOST_CHECK(Jr.isApprox(C.diffRetractation(x), 1e-6));
+  BOOST_CHECK(Jl.isApprox(C.diffPseudoLog0(x), 1e-6));
+  Eigen::MatrixXd Jf = Eigen::MatrixXd::Random(5, 3), J(5, 9);
+  C.applyDiffPseudoLog0(J, Jf, x);
+  BOOST_CHECK(J.isApprox(Jf * C.diffPseudoLog0(x)));
+}
+
 BOOST_AUTO_TEST_CASE(SO3Constructor)
 {
   SO3<ExpMapMatrix> S;
@@ -15,6 +15,7 @@
 // manifolds. If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
 
@@ -26,8 +27,10 @@
 #include <manifolds/SO3.h>
 #include <manifolds/Point.h>
 #include <manifolds/CartesianProduct.h>
+#include <manifolds/CayleyMapQuaternion.h>
 #include <manifolds/ExpMapMatrix.h>
 #include <manifolds/ExpMapQuaternion.h>
+#include <manifolds/FastTrig.h>
 
 #ifndef _WIN32
 #define BOOST_TEST_MODULE Manifolds
@@ -48,6 +51,206 @@ BOOST_AUTO_TEST_CASE(RotSpaceConstructor)
   BOOST_CHECK(S.isElementary());
 }
 
+BOOST_AUTO_TEST_CASE(QuaternionWxyzMapOperations)
+{
+  Eigen::Vector4d a = Eigen::Vector4d::Random();
+  Eigen::Vector4d b = Eigen::Vector4d::Random();
+  Eigen::Quaterniond qa(a[0], a[1], a[2], a[3]);
+  Eigen::Quaterniond qb(b[0], b[1], b[2], b[3]);
+
+  utils::ConstQuaternionWxyzMap ma(a.data());
+  BOOST_CHECK_EQUAL(ma.w(), a[0]);
+  BOOST_CHECK(ma.vec().data() == a.data() + 1);
+  BOOST_CHECK_CLOSE(ma.norm(), qa.norm(), 1e-12);
+
+  Eigen::Vector4d c;
+  utils::QuaternionWxyzMap mc(c.data());
+  mc.setProduct(ma, utils::ConstQuaternionWxyzMap(b.data()));
+  Eigen::Quaterniond ab = qa * qb;
+  BOOST_CHECK(c.isApprox(Eigen::Vector4d(ab.w(), ab.x(), ab.y(), ab.z())));
+
+  mc.setInverseProduct(ma, utils::ConstQuaternionWxyzMap(b.data()));
+  Eigen::Quaterniond iab = qa.inverse() * qb;
+  BOOST_CHECK(c.isApprox(Eigen::Vector4d(iab.w(), iab.x(), iab.y(), iab.z())));
+
+  // The result can be written in an operand
+  utils::QuaternionWxyzMap(a.data())
+      .setProduct(ma, utils::ConstQuaternionWxyzMap(b.data()));
+  BOOST_CHECK(a.isApprox(Eigen::Vector4d(ab.w(), ab.x(), ab.y(), ab.z())));
+
+  mc.normalize();
+  BOOST_CHECK_CLOSE(c.norm(), 1, 1e-12);
+  mc.setIdentity();
+  BOOST_CHECK(c.isApprox(Eigen::Vector4d(1, 0, 0, 0)));
+}
+
+BOOST_AUTO_TEST_CASE(SO3BatchKernels)
+{
+  // 21 columns: two full blocks and a partial one
+  const Index N = 21;
+  Eigen::MatrixXd V = Eigen::MatrixXd::Random(3, N);
+  V.col(0).setZero();
+  V.col(1) *= 1e-9;
+  V.col(2) = 3.1 * V.col(2).normalized();
+  V.col(3) << 1e-5, 0, 0;
+  Eigen::MatrixXd X(4, N), Y(4, N);
+  for (Index j = 0; j < N; ++j)
+  {
+    X.col(j) = Eigen::Vector4d::Random().normalized();
+    Y.col(j) = Eigen::Vector4d::Random().normalized();
+  }
+  X.col(4) << 0, 1, 0, 0;  // w = 0
+  X.col(5) << -1, 0, 0, 0;
+  X.col(6) = -X.col(7);  // w < 0
+  Y.col(8) = X.col(8);   // log of the identity
+
+  Eigen::MatrixXd Q(4, N), out3(3, N), out4(4, N);
+  ExpMapQuaternion::exponentialBatch(Q, V);
+  ExpMapQuaternion::logarithmBatch(out3, X);
+  for (Index j = 0; j < N; ++j)
+  {
+    ExpMapQuaternion::OutputType q;
+    ExpMapQuaternion::exponential(q, V.col(j));
+    BOOST_CHECK_SMALL((Q.col(j) - q).lpNorm<Eigen::Infinity>(), 1e-14);
+    Eigen::Vector3d v;
+    ExpMapQuaternion::logarithm(v, X.col(j));
+    BOOST_CHECK_SMALL((out3.col(j) - v).lpNorm<Eigen::Infinity>(), 1e-13);
+  }
+
+  SO3<ExpMapQuaternion> S;
+  S.retractationBatch(out4, X, V);
+  for (Index j = 0; j < N; ++j)
+  {
+    Eigen::Vector4d x;
+    S.retractation(x, X.col(j), V.col(j));
+    BOOST_CHECK_SMALL((out4.col(j) - x).lpNorm<Eigen::Infinity>(), 1e-14);
+  }
+  S.pseudoLogBatch(out3, X, Y);
+  for (Index j = 0; j < N; ++j)
+  {
+    Eigen::Vector3d v;
+    S.pseudoLog(v, X.col(j), Y.col(j));
+    BOOST_CHECK_SMALL((out3.col(j) - v).lpNorm<Eigen::Infinity>(), 1e-13);
+  }
+  S.pseudoLog0Batch(out3, Y);
+  for (Index j = 0; j < N; ++j)
+  {
+    Eigen::Vector3d v;
+    S.pseudoLog0(v, Y.col(j));
+    BOOST_CHECK_SMALL((out3.col(j) - v).lpNorm<Eigen::Infinity>(), 1e-13);
+  }
+
+  // In place retractation
+  Eigen::MatrixXd Z = X;
+  S.retractationBatch(Z, Z, V);
+  BOOST_CHECK(Z.isApprox(out4));
+}
+
+BOOST_AUTO_TEST_CASE(SO3FastTrig)
+{
+  SO3<ExpMapQuaternion> S;
+  SO3<FastTrig<ExpMapQuaternion> > F;
+  BOOST_CHECK(S.getTypeId() != F.getTypeId());
+  const double bound = FastTrig<ExpMapQuaternion>::errorBound;
+  for (int i = 0; i < 100; ++i)
+  {
+    Eigen::Vector3d v = Eigen::Vector3d::Random();
+    v *= (i % 2 ? 3.14 : 0.5) * std::abs(Eigen::Vector2d::Random()[0]) /
+         v.norm();
+    // the error decreases quickly with the angle
+    double prec = (i % 2 ? bound : 1e-15);
+    Point x = S.createRandomPoint();
+    Point y = S.createRandomPoint();
+    Eigen::Vector4d z, zF;
+    S.retractation(z, x.value(), v);
+    F.retractation(zF, x.value(), v);
+    BOOST_CHECK_SMALL((z - zF).lpNorm<Eigen::Infinity>(), prec);
+    Eigen::Vector3d w, wF;
+    S.pseudoLog(w, x.value(), y.value());
+    F.pseudoLog(wF, x.value(), y.value());
+    BOOST_CHECK_SMALL((w - wF).lpNorm<Eigen::Infinity>(), 1e-14);
+    S.pseudoLog0(w, y.value());
+    F.pseudoLog0(wF, y.value());
+    BOOST_CHECK_SMALL((w - wF).lpNorm<Eigen::Infinity>(), 1e-14);
+    F.pseudoLog(wF, x.value(), zF);
+    BOOST_CHECK_SMALL((v - wF).lpNorm<Eigen::Infinity>(),
+                      std::max(prec, 1e-13));
+  }
+  Eigen::Vector3d v(1e-9, -2e-10, 0), w;
+  Eigen::Vector4d z;
+  F.retractation(z, F.getZero().value(), v);
+  F.pseudoLog0(w, z);
+  BOOST_CHECK_SMALL((v - w).lpNorm<Eigen::Infinity>(), 1e-22);
+}
+
+BOOST_AUTO_TEST_CASE(SO3CayleyMap)
+{
+  SO3<ExpMapQuaternion> S;
+  SO3<CayleyMapQuaternion> C;
+  BOOST_CHECK(S.getTypeId() != C.getTypeId());
+  const Index N = 10;
+  Eigen::MatrixXd X(4, N), Y(4, N), Z(4, N), W(3, N);
+  Eigen::MatrixXd V = Eigen::MatrixXd::Random(3, N);
+  V.col(0) *= 10;  // the Cayley map is defined for any increment
+  for (Index j = 0; j < N; ++j)
+  {
+    X.col(j) = C.createRandomPoint().value();
+    Y.col(j) = C.createRandomPoint().value();
+  }
+
+  C.retractationBatch(Z, X, V);
+  C.pseudoLogBatch(W, X, Z);
+  BOOST_CHECK(W.isApprox(V));
+  for (Index j = 0; j < N; ++j)
+  {
+    Eigen::VectorXd z(4);
+    C.retractation(z, X.col(j), V.col(j));
+    BOOST_CHECK(z.isApprox(Z.col(j)));
+    BOOST_CHECK(C.isInM(z));
+    Eigen::Vector3d w;
+    C.pseudoLog(w, X.col(j), Y.col(j));
+    C.retractation(z, X.col(j), w);
+    BOOST_CHECK(z.isApprox(Y.col(j)));
+  }
+  C.pseudoLog0Batch(W, Y);
+  for (Index j = 0; j < N; ++j)
+  {
+    Eigen::Vector3d w;
+    C.pseudoLog0(w, Y.col(j));
+    BOOST_CHECK(w.isApprox(W.col(j)));
+  }
+
+  // The Cayley map is a second order approximation of the exponential
+  Eigen::Vector3d v = 1e-3 * Eigen::Vector3d::Random();
+  Eigen::VectorXd z(4), zC(4);
+  S.retractation(z, X.col(0), v);
+  C.retractation(zC, X.col(0), v);
+  BOOST_CHECK_SMALL((z - zC).lpNorm<Eigen::Infinity>(), 1e-9);
+
+  // Derivatives, checked by finite differences
+  const double h = 1e-8;
+  Eigen::VectorXd x = Y.col(1);
+  Eigen::MatrixXd Jr(4, 3), Jl(3, 4);
+  Eigen::Vector3d w0, w1;
+  C.pseudoLog0(w0, x);
+  for (Index i = 0; i < 3; ++i)
+  {
+    C.retractation(z, x, h * Eigen::Vector3d::Unit(i));
+    Jr.col(i) = (z - x) / h;
+  }
+  for (Index i = 0; i < 4; ++i)
+  {
+    z = x + h * Eigen::VectorXd::Unit(4, i);
+    C.pseudoLog0(w1, z);
+    Jl.col(i) = (w1 - w0) / h;
+  }
+  BOOST_CHECK(Jr.isApprox(C.diffRetractation(x), 1e-6));
+  BOOST_CHECK(Jl.isApprox(C.diffPseudoLog0(x), 1e-6));
+  Eigen::MatrixXd Jf = Eigen::MatrixXd::Random(5, 3), J(5, 4);
+  C.applyDiffPseudoLog0(J, Jf, x);
+  BOOST_CHECK(J.isApprox(Jf * C.diffPseudoLog0(x)));
+}
+
 BOOST_AUTO_TEST_CASE(SO3Zero)
 {
   SO3<ExpMapQuaternion> S;
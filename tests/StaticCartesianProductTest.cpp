@@ -0,0 +1,260 @@
+// Copyright (c) 2015 CNRS
+// Authors: Stanislas Brossette, Adrien Escande
+
+// This file is part of manifolds
+// manifolds is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+
+// manifolds is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// manifolds. If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <iostream>
+
+#include <manifolds/defs.h>
+#include <manifolds/utils.h>
+#include <manifolds/S2.h>
+#include <manifolds/SO3.h>
+#include <manifolds/RealSpace.h>
+#include <manifolds/CartesianProduct.h>
+#include <manifolds/StaticCartesianProduct.h>
+#include <manifolds/Point.h>
+#include <manifolds/ExpMapMatrix.h>
+#include <manifolds/ExpMapQuaternion.h>
+
+#ifndef _WIN32
+#define BOOST_TEST_MODULE Manifolds
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+using namespace mnf;
+
+typedef StaticCartesianProduct<FixedRealSpace<3>, SO3<ExpMapQuaternion>,
+                               FixedRealSpace<6> > R3SO3R6;
+typedef StaticCartesianProduct<StaticCartesianProduct<S2, SO3<ExpMapMatrix> >,
+                               FixedRealSpace<2> > S2SO3R2;
+
+// Checks that all the operations of the static product S give the same results
+// as the ones of the runtime product D
+void checkSameOperations(const Manifold& S, const Manifold& D)
+{
+  const Index c = 4;
+  Index t = S.tangentDim();
+  Index r = S.representationDim();
+  Eigen::VectorXd x(r), y(r), v(t), zS(r), zD(r), dS(t), dD(t);
+  S.createRandomPoint(x);
+  S.createRandomPoint(y);
+  S.forceOnTxM(v, 0.5 * Eigen::VectorXd::Random(t), x);
+  BOOST_CHECK(S.isInTxM(x, v));
+  BOOST_CHECK_EQUAL(S.isInTxM(x, v), D.isInTxM(x, v));
+
+  S.retractation(zS, x, v);
+  D.retractation(zD, x, v);
+  BOOST_CHECK(zS.isApprox(zD));
+
+  Eigen::MatrixXd JS(r, t), JD(r, t);
+  S.retractationWithJacobian(zS, JS, x, v);
+  D.retractationWithJacobian(zD, JD, x, v);
+  BOOST_CHECK(zS.isApprox(zD));
+  BOOST_CHECK(JS.isApprox(JD));
+
+  S.pseudoLog(dS, x, y);
+  D.pseudoLog(dD, x, y);
+  BOOST_CHECK(dS.isApprox(dD));
+
+  Eigen::MatrixXd JxS(t, r), JyS(t, r), JxD(t, r), JyD(t, r);
+  S.pseudoLogWithJacobian(dS, JxS, JyS, x, y);
+  D.pseudoLogWithJacobian(dD, JxD, JyD, x, y);
+  BOOST_CHECK(dS.isApprox(dD));
+  BOOST_CHECK(JxS.isApprox(JxD));
+  BOOST_CHECK(JyS.isApprox(JyD));
+
+  Eigen::VectorXd w = Eigen::VectorXd::Random(t);
+  S.forceOnTxM(dS, w, x);
+  D.forceOnTxM(dD, w, x);
+  BOOST_CHECK(dS.isApprox(dD));
+
+  Eigen::VectorXd p = x + 0.01 * Eigen::VectorXd::Random(r);
+  S.forceOnM(zS, p);
+  D.forceOnM(zD, p);
+  BOOST_CHECK(zS.isApprox(zD));
+
+  Eigen::MatrixXd Jr = Eigen::MatrixXd::Random(c, r);
+  Eigen::MatrixXd JtS(c, t), JtD(c, t);
+  S.applyDiffRetractation(JtS, Jr, x);
+  D.applyDiffRetractation(JtD, Jr, x);
+  BOOST_CHECK(JtS.isApprox(JtD));
+
+  Eigen::MatrixXd Ht = Eigen::MatrixXd::Random(t, c);
+  Eigen::MatrixXd HS(t, c), HD(t, c);
+  S.applyTransport(HS, Ht, x, v);
+  D.applyTransport(HD, Ht, x, v);
+  BOOST_CHECK(HS.isApprox(HD));
+  S.applyInvTransport(HS, Ht, x, v);
+  D.applyInvTransport(HD, Ht, x, v);
+  BOOST_CHECK(HS.isApprox(HD));
+
+  Eigen::MatrixXd Jt = Eigen::MatrixXd::Random(c, t);
+  S.applyInvTransportOnTheRight(JtS, Jt, x, v);
+  D.applyInvTransportOnTheRight(JtD, Jt, x, v);
+  BOOST_CHECK(JtS.isApprox(JtD));
+
+  Eigen::MatrixXd X(r, c), V(t, c), ZS(r, c), ZD(r, c), DS(t, c), DD(t, c);
+  for (Index j = 0; j < c; ++j)
+  {
+    S.createRandomPoint(X.col(j));
+    S.forceOnTxM(V.col(j), 0.5 * Eigen::VectorXd::Random(t), X.col(j));
+  }
+  S.retractationBatch(ZS, X, V);
+  D.retractationBatch(ZD, X, V);
+  BOOST_CHECK(ZS.isApprox(ZD));
+  S.pseudoLogBatch(DS, X, ZS);
+  D.pseudoLogBatch(DD, X, ZS);
+  BOOST_CHECK(DS.isApprox(DD));
+}
+
+BOOST_AUTO_TEST_CASE(StaticCartProdConstructor)
+{
+  R3SO3R6 S;
+  BOOST_CHECK_EQUAL(R3SO3R6::Dim, 12);
+  BOOST_CHECK_EQUAL(R3SO3R6::TangentDim, 12);
+  BOOST_CHECK_EQUAL(R3SO3R6::RepresentationDim, 13);
+  BOOST_CHECK_EQUAL(S.dim(), 12);
+  BOOST_CHECK_EQUAL(S.tangentDim(), 12);
+  BOOST_CHECK_EQUAL(S.representationDim(), 13);
+  BOOST_CHECK_EQUAL(S.numberOfSubManifolds(), 3);
+  BOOST_CHECK(!S.isElementary());
+  BOOST_CHECK_EQUAL(S.name(), "R3xSO3xR6");
+
+  BOOST_CHECK_EQUAL(S2SO3R2::Dim, 7);
+  BOOST_CHECK_EQUAL(S2SO3R2::TangentDim, 8);
+  BOOST_CHECK_EQUAL(S2SO3R2::RepresentationDim, 14);
+
+  RealSpace R3(3);
+  RealSpace R6(6);
+  SO3<ExpMapQuaternion> so3;
+  CartesianProduct D(R3, so3);
+  D.multiply(R6);
+  BOOST_CHECK(S.isSameTopology(D));
+  BOOST_CHECK(D.isSameTopology(S));
+
+  // The static operations only cover the template submanifolds
+  BOOST_CHECK(S.isLocked());
+  CartesianProduct& P = S;
+  BOOST_CHECK_THROW(P.multiply(R3), std::runtime_error);
+  BOOST_CHECK_EQUAL(S.representationDim(), 13);
+  BOOST_CHECK_EQUAL(S.numberOfSubManifolds(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(StaticCartProdFromInstances)
+{
+  FixedRealSpace<3> R3(2.0);
+  SO3<ExpMapQuaternion> so3(0.5);
+  FixedRealSpace<6> R6;
+  R3SO3R6 S(R3, so3, R6);
+  Eigen::VectorXd magnitude(12);
+  S.getTypicalMagnitude(magnitude);
+  BOOST_CHECK(magnitude.head<3>().isApprox(Eigen::Vector3d::Constant(2.0)));
+  BOOST_CHECK(magnitude.segment<3>(3).isApprox(Eigen::Vector3d::Constant(0.5)));
+}
+
+BOOST_AUTO_TEST_CASE(StaticCartProdOperations)
+{
+  R3SO3R6 S;
+  RealSpace R3(3);
+  RealSpace R6(6);
+  SO3<ExpMapQuaternion> so3;
+  CartesianProduct D(R3, so3);
+  D.multiply(R6);
+  checkSameOperations(S, D);
+
+  Index t = S.tangentDim();
+  Eigen::VectorXd x(S.representationDim()), dS(t), dD(t);
+  S.createRandomPoint(x);
+  S.pseudoLog0(dS, x);
+  D.pseudoLog0(dD, x);
+  BOOST_CHECK(dS.isApprox(dD));
+
+  Eigen::MatrixXd Jt = Eigen::MatrixXd::Random(4, t);
+  Eigen::MatrixXd JrS(4, S.representationDim()), JrD(4, S.representationDim());
+  S.applyDiffPseudoLog0(JrS, Jt, x);
+  D.applyDiffPseudoLog0(JrD, Jt, x);
+  BOOST_CHECK(JrS.isApprox(JrD));
+
+  Eigen::VectorXd zS(S.representationDim()), zD(S.representationDim());
+  S.setZero(zS);
+  D.setZero(zD);
+  BOOST_CHECK_EQUAL(zS, zD);
+}
+
+BOOST_AUTO_TEST_CASE(StaticCartProdNested)
+{
+  S2SO3R2 S;
+  S2 s2;
+  SO3<ExpMapMatrix> so3;
+  RealSpace R2(2);
+  CartesianProduct S2SO3(s2, so3);
+  CartesianProduct D(S2SO3, R2);
+  BOOST_CHECK(S.isSameTopology(D));
+  checkSameOperations(S, D);
+}
+
+BOOST_AUTO_TEST_CASE(StaticCartProdInCartesianProduct)
+{
+  R3SO3R6 S;
+  S2 s2;
+  CartesianProduct P(S, s2);
+  Point x = P.createRandomPoint();
+  Eigen::VectorXd v(P.tangentDim());
+  P.forceOnTxM(v, 0.5 * Eigen::VectorXd::Random(P.tangentDim()), x.value());
+  Point y = x + v;
+  Eigen::VectorXd z(S.representationDim());
+  S.retractation(z, x[0], v.head(S.tangentDim()));
+  BOOST_CHECK(z.isApprox(y[0]));
+}
+
+#if EIGEN_WORLD_VERSION > 3 ||                               \
+    (EIGEN_WORLD_VERSION == 3 && EIGEN_MAJOR_VERSION > 2) || \
+    (EIGEN_WORLD_VERSION == 3 && EIGEN_MAJOR_VERSION == 2 && \
+     EIGEN_MINOR_VERSION > 0)
+BOOST_AUTO_TEST_CASE(StaticCartProdNoAllocation)
+{
+  const int r = 100;
+  R3SO3R6 S;
+  Index dim = S.dim();
+  Index repDim = S.representationDim();
+  Eigen::VectorXd x = S.getZero().value();
+  Eigen::VectorXd p = Eigen::VectorXd::Random(dim);
+  Eigen::VectorXd z(repDim);
+  Eigen::VectorXd d(dim);
+  Eigen::MatrixXd J0 = Eigen::MatrixXd::Random(r, repDim);
+  Eigen::MatrixXd J1(r, dim);
+  Eigen::MatrixXd J2(r, repDim);
+  Eigen::MatrixXd H0 = Eigen::MatrixXd::Random(dim, dim);
+  Eigen::MatrixXd H1(dim, dim);
+
+  S.applyDiffRetractation(J1, J0, x);
+  S.applyDiffPseudoLog0(J2, J1, x);
+
+  Eigen::internal::set_is_malloc_allowed(false);
+  utils::set_is_malloc_allowed(false);
+  {
+    S.retractation(z, x, p);
+    S.pseudoLog(d, x, z);
+    S.pseudoLog0(d, z);
+    S.applyDiffRetractation(J1, J0, x);
+    S.applyDiffPseudoLog0(J2, J1, x);
+    S.applyTransport(H1, H0, x, p);
+    S.applyInvTransportOnTheRight(H1, H0, x, p);
+  }
+  utils::set_is_malloc_allowed(true);
+  Eigen::internal::set_is_malloc_allowed(true);
+}
+#endif